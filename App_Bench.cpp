@@ -0,0 +1,148 @@
+/**
+ * @brief SubStrip render benchmark
+ * @file App_Bench.cpp
+ * @version 0.1
+ * @date 2025-11-20
+ * @author Nello
+ */
+
+#include "App_Bench.h"
+
+#if defined(APP_BENCH) && APP_BENCH
+
+#include <esp_timer.h>
+#include "SubStrip.h"
+#include "App_PrintUtils.h"
+
+/*******************************************************************************
+ *  GLOBAL VARIABLES
+ ******************************************************************************/
+static const uint16_t tu16AppBench_Lengths[] = {10, 50, 100, 200, 600, 1000, 1500};
+static const uint8_t tu8AppBench_Speeds[] = {1, 2, 4};
+static const CRGB tAppBench_Colors[] = {CRGB::Blue, CRGB::Red, CRGB::White};
+static const uint8_t tu8AppBench_Particles[] = {1, 4, 8, 16, SUBSTRIP_MAX_PARTICLES};
+
+/*******************************************************************************
+ * @brief Run the render benchmark, results are printed as JSON lines
+ * @param u16Frames frames per measure, 0 for BENCH_FRAMES
+ ******************************************************************************/
+eApp_RetVal eAppBench_Run(uint16_t u16Frames) {
+    eApp_RetVal eRet = eRet_Ok;
+    char tcPrint[PRINT_UTILS_MAX_BUF];
+    uint16_t u16MaxLen = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZEOF(tu16AppBench_Lengths); i++) {
+        u16MaxLen = (tu16AppBench_Lengths[i] > u16MaxLen) ? tu16AppBench_Lengths[i] : u16MaxLen;
+    }
+    u16Frames = u16Frames ? u16Frames : BENCH_FRAMES;
+
+    // scratch buffers: effect state, composed output, previous effect state
+    CRGB *pLeds = (CRGB*)pvPortMalloc(3 * u16MaxLen * sizeof(CRGB));
+    uint16_t *pu16Active = (uint16_t*)pvPortMalloc(SUBSTRIP_MAX_LAYERS * u16MaxLen * sizeof(uint16_t));
+    SubStrip::TstParticle *pParticles = (SubStrip::TstParticle*)pvPortMalloc(SUBSTRIP_MAX_LAYERS * SUBSTRIP_MAX_PARTICLES * sizeof(SubStrip::TstParticle));
+    Palette *pPalette = new Palette();
+    if ((pLeds == nullptr) || (pu16Active == nullptr) || (pParticles == nullptr) || (pPalette == nullptr)) {
+        eRet = eRet_InternalError;
+    }
+    else {
+        CRGB *pOut = pLeds + u16MaxLen;
+        CRGB *pPrev = pOut + u16MaxLen;
+        pPalette->eLoad(tAppBench_Colors, ARRAY_SIZEOF(tAppBench_Colors));
+        for (uint8_t u8Anim = 0; u8Anim < SubStrip::NB_ANIMS; u8Anim++) {
+            for (uint8_t l = 0; l < ARRAY_SIZEOF(tu16AppBench_Lengths); l++) {
+                for (uint8_t s = 0; s < ARRAY_SIZEOF(tu8AppBench_Speeds); s++) {
+                    uint16_t u16Len = tu16AppBench_Lengths[l];
+                    uint32_t u32Now = 0;
+                    uint64_t u64Bytes = 0;
+                    int64_t i64Elapsed = 0;
+                    memset(pLeds, 0, u16Len * sizeof(CRGB));
+                    SubStrip xStrip(u16Len, pLeds);
+                    xStrip.eSetActivePool(pu16Active);
+                    xStrip.eSetParticlePool(pParticles);
+                    xStrip.eSetSeed(BENCH_SEED);
+                    xStrip.eSetAnimation((SubStrip::TeAnimation)u8Anim, pPalette, 1000, tu8AppBench_Speeds[s]);
+                    xStrip.vManageAnimation(u32Now); // clock sync, not measured
+                    xStrip.vClearDirty();
+                    for (uint16_t f = 0; f < u16Frames; f++) {
+                        memcpy(pPrev, pLeds, u16Len * sizeof(CRGB));
+                        u32Now += BENCH_FRAME_MS;
+                        int64_t i64Start = esp_timer_get_time();
+                        xStrip.vManageAnimation(u32Now);
+                        if (xStrip.bIsDirty())
+                        { xStrip.eGetSubStrip(pOut, u16Len); }
+                        i64Elapsed += esp_timer_get_time() - i64Start;
+
+                        if (xStrip.bIsDirty()) {
+                            for (uint16_t i = 0; i < u16Len; i++) {
+                                u64Bytes += (pLeds[i] != pPrev[i]) ? sizeof(CRGB) : 0;
+                            }
+                            u64Bytes += 2 * u16Len * sizeof(CRGB);
+                            xStrip.vClearDirty();
+                        }
+                    }
+                    snprintf(tcPrint, PRINT_UTILS_MAX_BUF,
+                        "{\"anim\":\"%s\",\"len\":%u,\"speed\":%u,\"frames\":%u,\"ns_frame\":%u,\"ns_led\":%u,\"bytes_frame\":%u}\r\n",
+                        SubStrip::pcGetAnimName((SubStrip::TeAnimation)u8Anim), u16Len, tu8AppBench_Speeds[s], u16Frames,
+                        (uint32_t)((i64Elapsed * 1000) / u16Frames), (uint32_t)((i64Elapsed * 1000) / ((int64_t)u16Frames * u16Len)),
+                        (uint32_t)(u64Bytes / u16Frames));
+                    APP_TRACE(tcPrint);
+                }
+            }
+        }
+    }
+    delete pPalette;
+    vPortFree(pParticles);
+    vPortFree(pu16Active);
+    vPortFree(pLeds);
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Run the particle benchmark, results are printed as JSON lines
+ * @param u16Frames frames per measure, 0 for BENCH_FRAMES
+ ******************************************************************************/
+eApp_RetVal eAppBench_Particles(uint16_t u16Frames) {
+    eApp_RetVal eRet = eRet_Ok;
+    char tcPrint[PRINT_UTILS_MAX_BUF];
+    u16Frames = u16Frames ? u16Frames : BENCH_FRAMES;
+
+    CRGB *pLeds = (CRGB*)pvPortMalloc(BENCH_PARTICLE_LEN * sizeof(CRGB));
+    uint16_t *pu16Active = (uint16_t*)pvPortMalloc(SUBSTRIP_MAX_LAYERS * BENCH_PARTICLE_LEN * sizeof(uint16_t));
+    SubStrip::TstParticle *pParticles = (SubStrip::TstParticle*)pvPortMalloc(SUBSTRIP_MAX_LAYERS * SUBSTRIP_MAX_PARTICLES * sizeof(SubStrip::TstParticle));
+    Palette *pPalette = new Palette();
+    if ((pLeds == nullptr) || (pu16Active == nullptr) || (pParticles == nullptr) || (pPalette == nullptr)) {
+        eRet = eRet_InternalError;
+    }
+    else {
+        pPalette->eLoad(tAppBench_Colors, ARRAY_SIZEOF(tAppBench_Colors));
+        for (uint8_t n = 0; n < ARRAY_SIZEOF(tu8AppBench_Particles); n++) {
+            uint8_t u8NbParticles = tu8AppBench_Particles[n];
+            memset(pLeds, 0, BENCH_PARTICLE_LEN * sizeof(CRGB));
+            SubStrip xStrip(BENCH_PARTICLE_LEN, pLeds);
+            xStrip.eSetActivePool(pu16Active);
+            xStrip.eSetParticlePool(pParticles);
+            xStrip.eSetColorPalette(pPalette);
+            xStrip.vClear(); // empty active list, tracked from now on
+            for (uint8_t p = 0; p < u8NbParticles; p++) {
+                // 1/16 pixel per step: about 12 pixels over 200 frames
+                xStrip.bSpawnParticle(((int32_t)p * (BENCH_PARTICLE_LEN / SUBSTRIP_MAX_PARTICLES)) << 8, 16, p, 0);
+            }
+            int64_t i64Start = esp_timer_get_time();
+            for (uint16_t f = 0; f < u16Frames; f++) {
+                xStrip.vStepParticles(1);
+            }
+            int64_t i64Elapsed = esp_timer_get_time() - i64Start;
+            snprintf(tcPrint, PRINT_UTILS_MAX_BUF,
+                "{\"particles\":%u,\"frames\":%u,\"ns_frame\":%u,\"ns_particle\":%u}\r\n",
+                xStrip.u8GetNbParticles(), u16Frames, (uint32_t)((i64Elapsed * 1000) / u16Frames),
+                (uint32_t)((i64Elapsed * 1000) / ((int64_t)u16Frames * u8NbParticles)));
+            APP_TRACE(tcPrint);
+        }
+    }
+    delete pPalette;
+    vPortFree(pParticles);
+    vPortFree(pu16Active);
+    vPortFree(pLeds);
+    return eRet;
+}
+
+#endif // APP_BENCH
@@ -0,0 +1,44 @@
+/**
+ * @brief SubStrip render benchmark
+ * @file App_Bench.h
+ * @version 0.1
+ * @date 2025-11-20
+ * @author Nello
+ */
+
+#ifndef _APP_BENCH_H
+#define _APP_BENCH_H
+
+#include "Config.h"
+
+#if defined(APP_BENCH) && APP_BENCH
+
+#define BENCH_FRAMES        200 // default frames per measure
+#define BENCH_FRAME_MS      20  // synthetic clock step, 50 fps
+#define BENCH_SEED          1   // same random stream on every run
+#define BENCH_PARTICLE_LEN  600
+
+/*
+ * Runs every animation on a scratch sub-strip, for each length and speed of
+ * the bench tables, driven by a synthetic clock (BENCH_FRAME_MS per frame)
+ * so the result does not depend on the wall clock. One JSON object per line:
+ * {"anim":"wave","len":100,"speed":1,"frames":200,"ns_frame":12345,"ns_led":123,"bytes_frame":600}
+ *  - ns_frame: vManageAnimation() + eGetSubStrip(), averaged
+ *  - ns_led: ns_frame per LED, flat across lengths when the cost is linear
+ *  - bytes_frame: pixel bytes changed by the effect plus the composition
+ *    copy (read + write) of dirty frames, averaged
+ * Only the render path is timed, the byte count is taken outside of it.
+ */
+eApp_RetVal eAppBench_Run(uint16_t u16Frames);
+
+/*
+ * Particle update cost against the number of particles in flight, on a
+ * BENCH_PARTICLE_LEN scratch sub-strip. Particles crawl so none of them
+ * leaves during the measure. One JSON object per line:
+ * {"particles":16,"frames":200,"ns_frame":12345,"ns_particle":771}
+ */
+eApp_RetVal eAppBench_Particles(uint16_t u16Frames);
+
+#endif // APP_BENCH
+
+#endif // _APP_BENCH_H
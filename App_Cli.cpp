@@ -10,6 +10,8 @@
 #include "App_Cli.h"
 #include "App_Leds.h"
 #include "App_PrintUtils.h"
+#include "App_Bench.h"
+#include "App_Timing.h"
 #include <string>
 
 // APP_CLI
@@ -40,8 +42,11 @@ static void vAppCli_Task(void* pvArg);
     PARAM(setWifi)                      \
     PARAM(setMqtt)                      \
     PARAM(substrip)                     \
-    PARAM(palette)
-#define NB_COMMANDS 9
+    PARAM(palette)                      \
+    PARAM(keepalive)                    \
+    PARAM(stats)                        \
+    PARAM(bench)
+#define NB_COMMANDS 12
 
 typedef enum {
     FOREACH_CLI_CMD(GENERATE_CMD_ENUM)
@@ -57,6 +62,9 @@ static void vCallback_setWifi(cmd* xCommand);
 static void vCallback_setMqtt(cmd* xCommand);
 static void vCallback_substrip(cmd* xCommand);
 static void vCallback_palette(cmd* xCommand);
+static void vCallback_keepalive(cmd* xCommand);
+static void vCallback_stats(cmd* xCommand);
+static void vCallback_bench(cmd* xCommand);
 
 static void vAppCli_SendResponse(const char* pcCommandName, eApp_RetVal eRetval, const char* pcExtraString);
 static char* pcReturnValueToString(eApp_RetVal eRet);
@@ -89,6 +97,9 @@ void vAppCli_init(void) {
     SET_MULTI(setWifi);
     SET_MULTI(setMqtt);
     SET_MULTI(substrip);
+    SET_BOUNDLESS(keepalive);
+    SET_BOUNDLESS(stats);
+    SET_BOUNDLESS(bench);
 
     for (size_t xCnt = 0; xCnt < ARRAY_SIZEOF(CtcAppCli_argSubstrip); xCnt++)
     {
@@ -252,6 +263,55 @@ static void vCallback_set(cmd* xCommand)
             case 1: //strips
                 eAppCfg_SetStrips(arg.getValue().c_str());
             break;
+
+            case 2: //outputs
+                eAppCfg_SetOutputs(arg.getValue().c_str());
+            break;
+
+            case 3: //power, LED current budget in mA, 0 for no limit
+            {
+                long lBudgetMa = arg.getValue().toInt();
+                eApp_RetVal eRet = (lBudgetMa >= 0) ? eAppLed_SetPowerBudget((uint32_t)lBudgetMa) : eRet_BadParameter;
+                if (eRet >= eRet_Ok) {
+                    bAppCfg_LockJson();
+                    jAppCfg_Config["DEVICE_POWER_MA"] = lBudgetMa;
+                    bAppCfg_UnlockJson();
+                }
+                else {
+                    snprintf(tcPrint, CLI_TX_BUFFER_SIZE, "  ->(%d) mA expected, 0 for no limit\r\n", eRet);
+                    APP_TRACE(tcPrint);
+                }
+            }
+            break;
+
+            case 4: //gamma x100, 100 for a linear output
+                if (eAppLed_SetGamma(arg.getValue().toInt()) >= eRet_Ok) {
+                    bAppCfg_LockJson();
+                    jAppCfg_Config["DEVICE_GAMMA"] = arg.getValue().toInt();
+                    bAppCfg_UnlockJson();
+                }
+            break;
+
+            case 5: //wb, white balance as RRGGBB hex
+            {
+                String strBalance = arg.getValue();
+                char *pcEnd = nullptr;
+                uint32_t u32Balance = strtoul(strBalance.c_str(), &pcEnd, 16);
+                bool bHex = (strBalance.length() == 6) && (*pcEnd == '\0');
+                for (uint8_t u8Digit = 0; bHex && (u8Digit < 6); u8Digit++)
+                { bHex = isxdigit((unsigned char)strBalance.c_str()[u8Digit]); } // no sign, space nor 0x
+                eApp_RetVal eRet = bHex ? eAppLed_SetWhiteBalance(CRGB(u32Balance)) : eRet_BadParameter;
+                if (eRet >= eRet_Ok) {
+                    bAppCfg_LockJson();
+                    jAppCfg_Config["DEVICE_WHITE_BALANCE"] = strBalance;
+                    bAppCfg_UnlockJson();
+                }
+                else {
+                    snprintf(tcPrint, CLI_TX_BUFFER_SIZE, "  ->(%d) RRGGBB expected, not 000000\r\n", eRet);
+                    APP_TRACE(tcPrint);
+                }
+            }
+            break;
             }
         }
         pcArgList++;
@@ -308,25 +368,122 @@ static void vCallback_setMqtt(cmd* xCommand)
 
 static void vCallback_substrip(cmd* xCommand) {
     Command cmd(xCommand);
-    uint8_t u8NbArg = cmd.countArgs() - 1;
     Argument arg = cmd.getArg("id");
     String strId = arg.getValue();
     char tcPrint[CLI_TX_BUFFER_SIZE];
-    uint8_t u8StripId = (strId == "all") ? -1 : atoi(strId.c_str());
-    eApp_RetVal eRetVal;
+    uint8_t u8StripId = (strId == "all") ? _LED_ALLSTRIPS : atoi(strId.c_str());
+    eApp_RetVal eRetVal = eRet_Ok;
     char **pcArgList = (char**)CtcAppCli_argSubstrip;
+    TstAppLed_Batch stBatch;
+    vAppLed_BatchInit(&stBatch);
     snprintf(tcPrint, CLI_TX_BUFFER_SIZE, "substrip[%s] set:\r\n", strId.c_str());
     APP_TRACE(tcPrint);
+    // all arguments are applied on the same frame, or none of them
     for (size_t xCnt = 0; xCnt < ARRAY_SIZEOF(CtcAppCli_argSubstrip); xCnt++)
     {
         arg = cmd.getArg(*pcArgList);
         if (arg.isSet())
         {
-            eRetVal = eAppLed_ConfigSubstrip(u8StripId, xCnt, (const char*)arg.getValue().c_str()); // processing
-            snprintf(tcPrint, CLI_TX_BUFFER_SIZE, " -%s = %s ->(%d)\r\n", *pcArgList, arg.getValue().c_str(), eRetVal);
+            eApp_RetVal eArgRet = eAppLed_BatchAdd(&stBatch, xCnt, (const char*)arg.getValue().c_str()); // parsing
+            eRetVal = (eArgRet < eRet_Ok) ? eArgRet : eRetVal;
+            snprintf(tcPrint, CLI_TX_BUFFER_SIZE, " -%s = %s ->(%d)\r\n", *pcArgList, arg.getValue().c_str(), eArgRet);
             APP_TRACE(tcPrint);
         }
         pcArgList++;
     }
+    if (eRetVal >= eRet_Ok)
+    { eRetVal = eAppLed_BatchCommit(&stBatch, u8StripId); } // processing
+    snprintf(tcPrint, CLI_TX_BUFFER_SIZE, " commit ->(%d)\r\n", eRetVal);
+    APP_TRACE(tcPrint);
     APP_TRACE("\r\n>");
 }
+
+static void vCallback_keepalive(cmd* xCommand) {
+    Command cmd(xCommand);
+    Argument xArg = cmd.getArgument(0);
+    String argStr = xArg.getValue();
+    uint16_t u16Value = argStr.toInt();
+    vAppCli_SendResponse(cmd.getName().c_str(), eAppLed_SetKeepAlive(u16Value), argStr.c_str());
+}
+
+static void vCallback_stats(cmd* xCommand) {
+    Command cmd(xCommand);
+    Argument xArg = cmd.getArgument(0);
+    TstAppLed_FrameCounters stCounters;
+    char tcPrint[CLI_TX_BUFFER_SIZE];
+    eApp_RetVal eRet = eRet_Ok;
+#if APP_TIMING
+    if (xArg.getValue() == "reset") {
+        vAppTiming_Reset();
+        vAppCli_SendResponse(cmd.getName().c_str(), eRet, NULL);
+        return;
+    }
+#endif
+    eRet = eAppLed_GetFrameCounters(&stCounters);
+    if (eRet >= eRet_Ok) {
+        snprintf(tcPrint, CLI_TX_BUFFER_SIZE, "frames shown: %u\r\nkeep-alive: %u\r\nskipped: %u\r\ndropped: %u\r\nbus time saved: %u ms\r\n",
+            stCounters.u32Shown, stCounters.u32KeepAlive, stCounters.u32Skipped, stCounters.u32Dropped, stCounters.u32BusTimeSavedMs);
+        APP_TRACE(tcPrint);
+    }
+    TstAppLed_PowerCounters stPower;
+    if (eAppLed_GetPowerCounters(&stPower) >= eRet_Ok) {
+        snprintf(tcPrint, CLI_TX_BUFFER_SIZE, "power budget: %u mA\r\nestimated: %u mA\r\ndrawn: %u mA (peak %u)\r\nbrightness: %u/%u\r\nlimited frames: %u\r\n",
+            stPower.u32BudgetMa, stPower.u32EstimatedMa, stPower.u32DrawnMa, stPower.u32PeakMa,
+            stPower.u8Applied, stPower.u8Brightness, stPower.u32LimitedFrames);
+        APP_TRACE(tcPrint);
+    }
+    // render task time per state, load in per mille of the wall time
+    for (uint8_t e = 0; e < eLedCpu_NbStates; e++) {
+        TstAppLed_CpuCounters stCpu;
+        if ((eAppLed_GetCpuCounters((TeAppLed_CpuState)e, &stCpu) >= eRet_Ok) && stCpu.u32Wakes) {
+            snprintf(tcPrint, CLI_TX_BUFFER_SIZE, "cpu %-8s wakes=%u busy=%u ms wall=%u ms load=%u/1000\r\n",
+                pcAppLed_GetCpuStateName((TeAppLed_CpuState)e), stCpu.u32Wakes,
+                (uint32_t)(stCpu.u64BusyUs / 1000), (uint32_t)(stCpu.u64WallUs / 1000),
+                stCpu.u64WallUs ? (uint32_t)((stCpu.u64BusyUs * 1000) / stCpu.u64WallUs) : 0);
+            APP_TRACE(tcPrint);
+        }
+    }
+#if APP_REALTIME
+    Realtime::TstCounters stRealtime;
+    if (eAppLed_GetRealtimeCounters(&stRealtime) >= eRet_Ok) {
+        snprintf(tcPrint, CLI_TX_BUFFER_SIZE, "realtime packets=%u frames=%u syncs=%u timeouts=%u\r\nrealtime drops:",
+            stRealtime.u32Packets, stRealtime.u32Frames, stRealtime.u32Syncs, stRealtime.u32Timeouts);
+        for (uint8_t d = 0; d < Realtime::NB_DROPS; d++) {
+            snprintf(tcPrint + strlen(tcPrint), CLI_TX_BUFFER_SIZE - strlen(tcPrint), " %s=%u",
+                Realtime::pcGetDropName((Realtime::TeDrop)d), stRealtime.tu32Drops[d]);
+        }
+        snprintf(tcPrint + strlen(tcPrint), CLI_TX_BUFFER_SIZE - strlen(tcPrint), "\r\n");
+        APP_TRACE(tcPrint);
+    }
+#endif
+#if APP_TIMING
+    // timings in us, p99 from a log-linear histogram (within 25%)
+    snprintf(tcPrint, CLI_TX_BUFFER_SIZE, "missed frames: %u\r\nprobe overhead: %u ns\r\n",
+        u32AppTiming_GetMissed(), u32AppTiming_GetOverheadNs());
+    APP_TRACE(tcPrint);
+    for (uint8_t p = 0; p < eTiming_NbProbes; p++) {
+        TstAppTiming_Summary stSummary;
+        eAppTiming_GetSummary((TeAppTiming_Probe)p, &stSummary);
+        snprintf(tcPrint, CLI_TX_BUFFER_SIZE, "%-8s n=%u min=%u.%03u avg=%u.%03u max=%u.%03u p99=%u.%03u us\r\n",
+            pcAppTiming_GetName((TeAppTiming_Probe)p), stSummary.u32Count,
+            stSummary.u32MinNs / 1000, stSummary.u32MinNs % 1000, stSummary.u32AvgNs / 1000, stSummary.u32AvgNs % 1000,
+            stSummary.u32MaxNs / 1000, stSummary.u32MaxNs % 1000, stSummary.u32P99Ns / 1000, stSummary.u32P99Ns % 1000);
+        APP_TRACE(tcPrint);
+    }
+#endif
+    vAppCli_SendResponse(cmd.getName().c_str(), eRet, NULL);
+}
+
+static void vCallback_bench(cmd* xCommand) {
+    Command cmd(xCommand);
+    Argument xArg = cmd.getArgument(0);
+    String argStr = xArg.getValue();
+    eApp_RetVal eRet = eRet_Error;
+#if APP_BENCH
+    if (argStr == "particles")
+    { eRet = eAppBench_Particles(cmd.getArgument(1).getValue().toInt()); }
+    else
+    { eRet = eAppBench_Run(argStr.toInt()); }
+#endif
+    vAppCli_SendResponse(cmd.getName().c_str(), eRet, argStr.c_str());
+}
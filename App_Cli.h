@@ -22,7 +22,12 @@
     PARAM(fade)                         \
     PARAM(dir)                          \
     PARAM(offset)                       \
-    PARAM(bpm)
+    PARAM(bpm)                          \
+    PARAM(fps)                          \
+    PARAM(width)                        \
+    PARAM(seed)                         \
+    PARAM(xfade)                        \
+    PARAM(layer)
 
 #define FOREACH_SETMQTT_ARG(PARAM)      \
     PARAM(addr)                         \
@@ -34,7 +39,11 @@
 
 #define FOREACH_SET_ARG(PARAM)          \
     PARAM(deviceName)                   \
-    PARAM(strips)
+    PARAM(strips)                       \
+    PARAM(outputs)                      \
+    PARAM(power)                        \
+    PARAM(gamma)                        \
+    PARAM(wb)
 
 #define FOREACH_PALETTE_ARG(PARAM)      \
     PARAM(list)                         \
@@ -8,6 +8,14 @@
 
 #include "App_Leds.h"
 #include "App_PrintUtils.h"
+#include "LedOutput.h"
+#include "Kernels.h"
+#include "App_Timing.h"
+#include "Timeslot.h"
+#include <time.h>
+#if APP_REALTIME
+#include "App_Wifi.h"
+#endif
 #include <list>
 
 #if defined(APP_FASTLED) && APP_FASTLED
@@ -15,12 +23,17 @@
 /*******************************************************************************
  *  CONFIGURATION
  ******************************************************************************/
-#define LED_DATA_PIN        4
-#define LED_CHIPSET         WS2812
-#define LED_PIXEL_ORDER     GRB
+#define LED_DATA_PIN        4 // single output when DEVICE_OUTPUTS is not usable
 #define LED_BRIGHTNESS      127
-#define LED_CHANGE_DELAY    5000
+#define LED_PLAYLIST_MAX    16 // steps kept from DEVICE_PROG_ANIM
+#define LED_XFADE_MS        1500 // crossfade of a playlist step without XFADE
+#define LED_WAKE_FADE_MS    3000 // brightness ramp when leaving a blackout
+#define LED_SCHED_MAX_WAIT_S    600 // longest scheduler sleep, catches wall clock jumps
+#define LED_SCHED_NO_CLOCK_S    10 // scheduler poll until the wall clock is set
+#define LED_SCHED_MIN_YEAR      2024 // older wall clock: not set yet, always on
 #define LED_STATIC_PALETTE_NB  6
+#define LED_KEEPALIVE_MS    1000 // refresh period of an unchanged frame, 0: never
+#define LED_IDLE_MIN_MS     100 // shortest static period the render blocks for
 
 #if APP_TASKS
 // APP_LEDS Task
@@ -28,20 +41,52 @@
 #define LED_TASK_HEAP       (configMINIMAL_STACK_SIZE*2)
 #define LED_TASK_PARAM      NULL
 #define LED_TASK_PRIO       2
-#define LED_TASK_HANDLE     NULL
+
+// APP_LEDS_TX Task: transmits composed frames while the next one renders
+#define LED_TX_TASK         "APP_LEDS_TX"
+#define LED_TX_TASK_HEAP    (configMINIMAL_STACK_SIZE*2)
+#define LED_TX_TASK_PARAM   NULL
+#define LED_TX_TASK_PRIO    3
+
+#if CONFIG_FREERTOS_UNICORE
+#define LED_TASK_CORE       0
+#define LED_TX_TASK_CORE    0
+#else
+#define LED_TASK_CORE       1 // render, with the application
+#define LED_TX_TASK_CORE    0 // transmit
+#endif
 
 // APP_ANIM Task
 #define ANIM_TASK           "APP_ANIM"
-#define ANIM_TASK_HEAP      (configMINIMAL_STACK_SIZE*2)
+#define ANIM_TASK_HEAP      (configMINIMAL_STACK_SIZE*3)
 #define ANIM_TASK_PARAM     NULL
 #define ANIM_TASK_PRIO      2
-#define ANIM_TASK_HANDLE    NULL
+
+// APP_SCHED Task: working timeslots
+#define SCHED_TASK          "APP_SCHED"
+#define SCHED_TASK_HEAP     (configMINIMAL_STACK_SIZE*3)
+#define SCHED_TASK_PARAM    NULL
+#define SCHED_TASK_PRIO     1
+
+// APP_RT Task: waits for a realtime stream, hands the output to the render
+#define RT_TASK             "APP_RT"
+#define RT_TASK_HEAP        (configMINIMAL_STACK_SIZE*3)
+#define RT_TASK_PARAM       NULL
+#define RT_TASK_PRIO        2
 #endif
 
 #define _LED_TIMEOUT        (1000/SUBSTRIP_FPS) //ms
+#define _LED_MAX_SLEEP      100 //ms, longest wait of the RUN scheduler
+#define _LED_MAX_IDLE       60000 //ms, longest timed wait of an idle render
+#define _LED_RT_POLL_MS     50 //ms, longest receive wait of the FIXED state
+#define _LED_RT_WAIT_MS     1000 //ms, longest wait of the realtime task
 #define _LED_NB             (LED_SUBSTRIP_LEN * LED_SUBSTRIP_NB)
 #define _LED_SUB_OFFSET(x)  (x * LED_SUBSTRIP_LEN)
 #define _LOOP_CNT_MS(x)     (x/_LED_TIMEOUT)
+#define _LED_OUT_BUFFERS    3 // on the wire, ready to transmit, being composed
+#define _LED_NO_FRAME       ((uint8_t)0xFF)
+#define _LED_PENDING_ALL    ((uint8_t)((1 << _LED_OUT_BUFFERS) - 1))
+#define GENERATE_LED_CPU_STR(ENUM, NAME)    #NAME,
 
 /*******************************************************************************
  *  TYPES, ENUM, DEFINITIONS 
@@ -49,20 +94,30 @@
 typedef struct {
     uint16_t u16NbLeds;
     uint8_t u8NbStrips;
-    uint8_t* pu8Strips;
-    CRGB* pLedStrip;
+    uint16_t* pu16Strips;
+    uint8_t* pu8Pending; // per substrip, output buffers it still has to be composed into
+    CRGB* tpOutBuffers[_LED_OUT_BUFFERS]; // front is shown by the output controller
+    uint8_t u8Back; // index of the buffer composed by the LED task
+    uint8_t u8Front; // index of the buffer on the wire, owned by the transmit task
+    volatile uint8_t u8Ready; // composed, waiting for transmit, _LED_NO_FRAME if none
     CRGB* pSubstripAssemly;
+    CRGB* pLayerPool; // overlay layers of all sub-strips
+    uint16_t* pu16ActivePool; // lit pixel lists of all sub-strips and layers
+    SubStrip::TstParticle* pParticlePool; // particles of all sub-strips and layers
+    CRGB* pTransitionPool; // crossfaded images of all sub-strips
+    uint32_t* pu32Power; // per substrip, weighted channel sum of its last composition
+    uint32_t u32PowerSum; // sum of pu32Power, updated per composed substrip
     SubStrip *SubStrips;
 } TstStripCfg;
 
 typedef struct {
     SubStrip::TeAnimation eAnimation;
     uint32_t u32Period;
-    uint8_t u8Offset;
+    uint16_t u16Offset;
     uint8_t u8Speed;
     uint16_t u16MsFade;
     SubStrip::TeDirection eDirection;
-    CRGB* pPalette;
+    const Palette* pPalette;
 } TstConfig;
 
 typedef enum {
@@ -72,43 +127,119 @@ typedef enum {
     LEDSTRIP_FIXED,
 } TeAppLED_LedstripStates;
 
+// DEVICE_PROG_ANIM entry, compiled at init: no JSON nor name lookup afterwards
+typedef struct {
+    uint8_t u8Anim; // SubStrip::TeAnimation
+    uint16_t u16DurationS;
+    uint16_t u16XfadeMs;
+} TstAppLed_PlayStep;
+
 /*******************************************************************************
  *  GLOBAL VARIABLES
  ******************************************************************************/
-static TstStripCfg stAppLED_Config  = {0, 0, nullptr, nullptr, nullptr};
-static CRGB pMyColorPalette1[3] = {CRGB::White, CRGB::Red, CRGB::Black};
-static CRGB tCustomPalettes[LED_SUBSTRIP_NB][LED_STATIC_PALETTE_NB + 1] = {{{CRGB::Black}}};
+static TstStripCfg stAppLED_Config  = {0, 0, nullptr, nullptr, {nullptr}, 0, 0, _LED_NO_FRAME, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, nullptr};
+static const CRGB tMyColors1[] = {CRGB::White, CRGB::Red};
+static Palette MyColorPalette1; // built at init from tMyColors1
+static Palette tCustomPalettes[LED_PALETTE_NB]; // render side
+static Palette tStagedPalettes[LED_PALETTE_NB]; // edited by writers, latched by the render
+static Palette tAppLed_LatchPalettes[LED_PALETTE_NB]; // render copies, kept with the parameters
+static uint32_t tu32AppLed_PaletteStamps[LED_PALETTE_NB];
+static Palette xAppLed_PaletteEdit; // writers, under xAppLed_PaletteMutex
+static SemaphoreHandle_t xAppLed_PaletteMutex; // palette writers only, never the render
+static const char* CtcAppLed_argSubstrip[] = {
+    FOREACH_SUBSTRIP_ARG(GENERATE_STR)
+};
+static uint8_t u8AppLed_NbLayers = 0; // DEVICE_LAYERS, overlay layers with a pool
+static TstAppLed_Params *pstAppLed_Params; // posted by writers
+static TstAppLed_Params *pstAppLed_Latched; // render copy
+static volatile uint32_t u32AppLed_ParamSeq = 0; // seqlock, odd while written
+static uint32_t u32AppLed_LatchedSeq = 0;
+static portMUX_TYPE xAppLed_ParamMux = portMUX_INITIALIZER_UNLOCKED; // writers only
 static TeAppLED_LedstripStates eAppLed_CurrentState = LEDSTRIP_BLACKOUT;
 
 static CRGB *ledStrip;
+static const TstLedOutput_Driver *pLedOutput;
 static SubStrip *SubStrips;
 
 
 static const TstConfig AnimationConfig[LED_SUBSTRIP_NB] = {
 //   Animation              Period   Offset  Speed   MsFade  Direction                   Palette
-    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    pMyColorPalette1},
-    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    pMyColorPalette1},
-    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    pMyColorPalette1},
-    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    pMyColorPalette1},
-    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    pMyColorPalette1},
+    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    &MyColorPalette1},
+    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    &MyColorPalette1},
+    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    &MyColorPalette1},
+    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    &MyColorPalette1},
+    {SubStrip::RAINDROPS,   2000,    0,      2,      100,    SubStrip::FORWARD_INOUT,    &MyColorPalette1},
 };
 
-static bool bAppLed_displayOn = false;
+static TstAppLed_PlayStep tAppLed_Playlist[LED_PLAYLIST_MAX];
+static uint8_t u8AppLed_PlaylistLen = 0;
+static Timeslot xAppLed_Timeslots; // DEVICE_WORKING_TIMESLOT
+static volatile bool bAppLed_Asleep = false; // outside the working timeslots
+static uint32_t u32AppLed_RampStart = 0; // render task only
+static uint8_t u8AppLed_Ramp = 255; // brightness ramp after a blackout, 255: done
 
-const char *tpcAppLED_Animations[SubStrip::NB_ANIMS] = {
-    "none",
-    "glitter",
-    "raindrops",
-    "checkered",
-    "wave"
+static bool bAppLed_displayOn = false;
+static volatile bool bAppLed_ForceShow = false;
+static uint16_t u16AppLed_KeepAliveMs = LED_KEEPALIVE_MS;
+static TstAppLed_FrameCounters stAppLed_Counters;
+static TstAppLed_PowerCounters stAppLed_Power = {0, 0, 0, 0, 0, LED_BRIGHTNESS, LED_BRIGHTNESS};
+static OutputLut tAppLed_Luts[2]; // active output table and the one built on a change
+static uint8_t u8AppLed_Lut = 0; // active table, render task only
+static uint8_t u8AppLed_LutRev = 0; // output settings revision of the active table
+static volatile uint8_t u8AppLed_OutputRev = 0; // incremented on a gamma/balance change
+static volatile uint16_t u16AppLed_Gamma100 = OUTPUT_LUT_GAMMA_DEF;
+static volatile uint32_t u32AppLed_Balance = OUTPUT_LUT_WB_DEF;
+static TstAppLed_CpuCounters tAppLed_Cpu[eLedCpu_NbStates];
+static portMUX_TYPE xAppLed_CpuMux = portMUX_INITIALIZER_UNLOCKED; // 64 bit counters
+static const char *CtcAppLed_CpuStates[] = {
+    FOREACH_LED_CPU_STATE(GENERATE_LED_CPU_STR)
 };
+#if APP_REALTIME
+static Realtime xAppLed_Realtime; // DEVICE_REALTIME, read by the render in LEDSTRIP_FIXED only
+#endif
 
 #if APP_TASKS
-SemaphoreHandle_t xLedStripSema;
+static TaskHandle_t xAppLed_TxTask = NULL;
+static TaskHandle_t xAppLed_Task = NULL;
+static TaskHandle_t xAppLed_AnimTask = NULL;
+static TaskHandle_t xAppLed_RtTask = NULL;
+static portMUX_TYPE xAppLed_BufferMux = portMUX_INITIALIZER_UNLOCKED; // buffer roles
 void vAppLedsTask(void *pvParam);
+void vAppLedsTxTask(void *pvParam);
 void vAppLedsAnimTask(void *pvParam);
+void vAppLedsScheduleTask(void *pvParam);
+void vAppLedsRealtimeTask(void *pvParam);
+#endif
+static void vAppLed_PublishFrame(void);
+static eApp_RetVal eAppLed_CheckParams(uint8_t u8Index, uint32_t u32Mask, const TstAppLed_Params *pstValues);
+static eApp_RetVal eAppLed_PostParams(uint8_t u8Index, uint32_t u32Mask, const TstAppLed_Params *pstValues);
+static uint32_t u32AppLed_WriteBegin(void);
+static void vAppLed_WriteEnd(uint32_t u32Stamp);
+static void vAppLed_StagePalette(uint8_t u8PaletteIndex, const Palette *pxPalette);
+static void vAppLed_CopyParam(TstAppLed_Params *pstDst, const TstAppLed_Params *pstSrc, uint8_t u8Param);
+static void vAppLed_ApplyParam(SubStrip *pObj, const TstAppLed_Params *pstParams, uint8_t u8Param);
+static void vAppLed_LatchParams(void);
+static void vAppLed_RequestShow(void);
+static void vAppLed_Wake(void);
+static uint32_t u32AppLed_IdleMs(uint32_t u32Now);
+static void vAppLed_CountCpu(TeAppLed_CpuState eState, uint32_t u32BusyUs, uint32_t u32WallUs);
+static uint8_t u8AppLed_LoadOutputs(TstLedOutput_Port *pstPorts, uint16_t u16NbLeds);
+static uint8_t u8AppLed_LoadPlaylist(void);
+static void vAppLed_PostStep(uint8_t u8Step);
+static uint8_t u8AppLed_LoadTimeslots(void);
+static void vAppLed_Sleep(bool bSleep);
+static void vAppLed_StepRamp(uint32_t u32Now);
+static uint8_t u8AppLed_TargetBrightness(void);
+static uint32_t u32AppLed_StripPower(const CRGB *pLeds, uint16_t u16NbLeds);
+static uint8_t u8AppLed_LimitPower(uint8_t u8LutBrightness);
+static void vAppLed_ComposeStrip(uint8_t u8Sub, CRGB *pOut, uint8_t u8BackMask);
+static void vAppLed_SettleOutput(void);
+#if APP_REALTIME
+static bool bAppLed_LoadRealtime(void);
+static void vAppLed_SettleRealtime(CRGB *pFrame, const CRGB *pLast);
+static void vAppLed_LeaveRealtime(void);
+static bool bAppLed_SwapState(TeAppLED_LedstripStates eFrom, TeAppLED_LedstripStates eTo);
 #endif
-uint8_t u8StrList2Index(const char* pcToSearch, const char **pcStrList, uint8_t u8LstSize);
 
 /*******************************************************************************
  * @brief Initialize ledstrip
@@ -123,51 +254,120 @@ void AppLED_init(void) {
     stAppLED_Config.u8NbStrips = jStrips.size();
     if (stAppLED_Config.u8NbStrips)
     {
-        stAppLED_Config.pu8Strips = (uint8_t*)pvPortMalloc(stAppLED_Config.u8NbStrips * sizeof(uint8_t));
-        if (stAppLED_Config.pu8Strips)
+        stAppLED_Config.pu16Strips = (uint16_t*)pvPortMalloc(stAppLED_Config.u8NbStrips * sizeof(uint16_t));
+        if (stAppLED_Config.pu16Strips)
         {
-            uint8_t *ptr = stAppLED_Config.pu8Strips;
-            for (uint8_t u8Val : jStrips)
+            uint16_t *ptr = stAppLED_Config.pu16Strips;
+            for (uint16_t u16Val : jStrips)
             {
-                *ptr = u8Val;
-                stAppLED_Config.u16NbLeds += u8Val;
+                u16Val = (u16Val > SUBSTRIP_MAX_LEDS) ? SUBSTRIP_MAX_LEDS : u16Val; // as SubStrip does
+                *ptr = u16Val;
+                stAppLED_Config.u16NbLeds += u16Val;
                 ptr++;
             }
         }
         else 
         { APP_TRACE("[AppLED_init] Malloc error !\r\n"); }
     }
+    stAppLed_Power.u32BudgetMa = jAppCfg_Config["DEVICE_POWER_MA"] | 0;
+    u8AppLed_NbLayers = jAppCfg_Config["DEVICE_LAYERS"] | 0;
+    u8AppLed_NbLayers = (u8AppLed_NbLayers < SUBSTRIP_MAX_LAYERS) ? u8AppLed_NbLayers : (SUBSTRIP_MAX_LAYERS - 1);
+    bool bXfade = (jAppCfg_Config["DEVICE_XFADE"] | 1) != 0;
+    u16AppLed_Gamma100 = jAppCfg_Config["DEVICE_GAMMA"] | OUTPUT_LUT_GAMMA_DEF;
+    u16AppLed_Gamma100 = (u16AppLed_Gamma100 && (u16AppLed_Gamma100 <= OUTPUT_LUT_GAMMA_MAX)) ? u16AppLed_Gamma100 : OUTPUT_LUT_GAMMA_DEF;
+    u32AppLed_Balance = strtoul(jAppCfg_Config["DEVICE_WHITE_BALANCE"] | "FFB0F0", nullptr, 16);
+    u32AppLed_Balance = u32AppLed_Balance ? u32AppLed_Balance : OUTPUT_LUT_WB_DEF;
     bAppCfg_UnlockJson();
 
-    if (stAppLED_Config.u16NbLeds && stAppLED_Config.u8NbStrips && stAppLED_Config.pu8Strips)
+    if (stAppLED_Config.u16NbLeds && stAppLED_Config.u8NbStrips && stAppLED_Config.pu16Strips)
     {
-        stAppLED_Config.pLedStrip = (CRGB*)pvPortMalloc(stAppLED_Config.u16NbLeds * sizeof(CRGB)); // Dynamic allocation, main display
+        stAppLED_Config.tpOutBuffers[0] = (CRGB*)pvPortMalloc(stAppLED_Config.u16NbLeds * sizeof(CRGB)); // Dynamic allocation, main display
+        stAppLED_Config.tpOutBuffers[1] = (CRGB*)pvPortMalloc(stAppLED_Config.u16NbLeds * sizeof(CRGB)); // Dynamic allocation, display back buffer
+        stAppLED_Config.tpOutBuffers[2] = (CRGB*)pvPortMalloc(stAppLED_Config.u16NbLeds * sizeof(CRGB)); // Dynamic allocation, display ready buffer
+        stAppLED_Config.pu8Pending = (uint8_t*)pvPortMalloc(stAppLED_Config.u8NbStrips * sizeof(uint8_t));
         stAppLED_Config.pSubstripAssemly = (CRGB*)pvPortMalloc(stAppLED_Config.u16NbLeds * sizeof(CRGB)); // Dynamic allocation, fx generator
+        // sized from DEVICE_LAYERS and DEVICE_XFADE: 2 B/LED without, 5 with the crossfade (default), 15 with two layers
+        if (u8AppLed_NbLayers)
+        { stAppLED_Config.pLayerPool = (CRGB*)pvPortMalloc(u8AppLed_NbLayers * stAppLED_Config.u16NbLeds * sizeof(CRGB)); } // Dynamic allocation, overlay layers
+        stAppLED_Config.pu16ActivePool = (uint16_t*)pvPortMalloc((1 + u8AppLed_NbLayers) * stAppLED_Config.u16NbLeds * sizeof(uint16_t)); // Dynamic allocation, sparse effects
+        stAppLED_Config.pParticlePool = (SubStrip::TstParticle*)pvPortMalloc(stAppLED_Config.u8NbStrips * (1 + u8AppLed_NbLayers) * SUBSTRIP_MAX_PARTICLES * sizeof(SubStrip::TstParticle)); // Dynamic allocation, drops and comets
+        if (bXfade)
+        { stAppLED_Config.pTransitionPool = (CRGB*)pvPortMalloc(stAppLED_Config.u16NbLeds * sizeof(CRGB)); } // Dynamic allocation, crossfades
+        stAppLED_Config.pu32Power = (uint32_t*)pvPortMalloc(stAppLED_Config.u8NbStrips * sizeof(uint32_t));
         stAppLED_Config.SubStrips = (SubStrip*)pvPortMalloc(stAppLED_Config.u8NbStrips * sizeof(SubStrip)); // Dynamic allocation
-        if ((stAppLED_Config.pLedStrip != nullptr) && (stAppLED_Config.SubStrips != nullptr))
+        pstAppLed_Params = (TstAppLed_Params*)pvPortMalloc(stAppLED_Config.u8NbStrips * sizeof(TstAppLed_Params));
+        pstAppLed_Latched = (TstAppLed_Params*)pvPortMalloc(stAppLED_Config.u8NbStrips * sizeof(TstAppLed_Params));
+        xAppLed_PaletteMutex = xSemaphoreCreateMutex();
+        if ((stAppLED_Config.tpOutBuffers[0] != nullptr) && (stAppLED_Config.tpOutBuffers[1] != nullptr) && (stAppLED_Config.tpOutBuffers[2] != nullptr) &&
+            (stAppLED_Config.pu8Pending != nullptr) && (stAppLED_Config.pSubstripAssemly != nullptr) && (stAppLED_Config.SubStrips != nullptr) &&
+            (pstAppLed_Params != nullptr) && (pstAppLed_Latched != nullptr) && (stAppLED_Config.pu32Power != nullptr) &&
+            (stAppLED_Config.pu16ActivePool != nullptr) && (stAppLED_Config.pParticlePool != nullptr) &&
+            ((stAppLED_Config.pLayerPool != nullptr) || !u8AppLed_NbLayers) &&
+            ((stAppLED_Config.pTransitionPool != nullptr) || !bXfade) && (xAppLed_PaletteMutex != nullptr))
         {
             snprintf(tcPrint, PRINT_UTILS_MAX_BUF, "[AppLED_init] Loading %u strips:", stAppLED_Config.u8NbStrips);
             CRGB *pSub = stAppLED_Config.pSubstripAssemly;
+            CRGB *pLayers = stAppLED_Config.pLayerPool;
+            uint16_t *pu16Active = stAppLED_Config.pu16ActivePool;
+            CRGB *pTransition = stAppLED_Config.pTransitionPool;
             for (uint8_t u8cnt = 0; u8cnt < stAppLED_Config.u8NbStrips; u8cnt++)
             {
-                stAppLED_Config.SubStrips[u8cnt] = SubStrip(stAppLED_Config.pu8Strips[u8cnt], pSub);
-                snprintf(tcPrint + strlen(tcPrint), PRINT_UTILS_MAX_BUF - strlen(tcPrint), " %u", stAppLED_Config.pu8Strips[u8cnt]);
-                pSub += stAppLED_Config.pu8Strips[u8cnt];
+                stAppLED_Config.SubStrips[u8cnt] = SubStrip(stAppLED_Config.pu16Strips[u8cnt], pSub);
+                if (pLayers != nullptr) {
+                    stAppLED_Config.SubStrips[u8cnt].eSetLayerPool(pLayers, u8AppLed_NbLayers);
+                    pLayers += u8AppLed_NbLayers * stAppLED_Config.pu16Strips[u8cnt];
+                }
+                stAppLED_Config.SubStrips[u8cnt].eSetActivePool(pu16Active, u8AppLed_NbLayers);
+                pu16Active += (1 + u8AppLed_NbLayers) * stAppLED_Config.pu16Strips[u8cnt];
+                if (pTransition != nullptr) { // none: crossfades are cuts
+                    stAppLED_Config.SubStrips[u8cnt].eSetTransitionBuffer(pTransition);
+                    pTransition += stAppLED_Config.pu16Strips[u8cnt];
+                }
+                stAppLED_Config.SubStrips[u8cnt].eSetParticlePool(stAppLED_Config.pParticlePool + u8cnt * (1 + u8AppLed_NbLayers) * SUBSTRIP_MAX_PARTICLES, u8AppLed_NbLayers);
+                snprintf(tcPrint + strlen(tcPrint), PRINT_UTILS_MAX_BUF - strlen(tcPrint), " %u", stAppLED_Config.pu16Strips[u8cnt]);
+                pSub += stAppLED_Config.pu16Strips[u8cnt];
             }
             snprintf(tcPrint + strlen(tcPrint), PRINT_UTILS_MAX_BUF - strlen(tcPrint), "\r\nTotal ledstrip: %u\r\n", stAppLED_Config.u16NbLeds);
             APP_TRACE(tcPrint);
-            ledStrip = stAppLED_Config.pLedStrip;
+            stAppLED_Config.u8Front = 0;
+            stAppLED_Config.u8Back = 1;
+            stAppLED_Config.u8Ready = _LED_NO_FRAME;
+            ledStrip = stAppLED_Config.tpOutBuffers[0];
             SubStrips = stAppLED_Config.SubStrips;
-            FastLED.addLeds<LED_CHIPSET, LED_DATA_PIN, LED_PIXEL_ORDER>(ledStrip, stAppLED_Config.u16NbLeds);
-            FastLED.setBrightness(LED_BRIGHTNESS);
-            FastLED.setCorrection(TypicalLEDStrip);
-            FastLED.clear();
-            FastLED.show();
+            for (uint8_t u8Buf = 1; u8Buf < _LED_OUT_BUFFERS; u8Buf++)
+            { memset(stAppLED_Config.tpOutBuffers[u8Buf], 0, stAppLED_Config.u16NbLeds * sizeof(CRGB)); }
+            memset(stAppLED_Config.pu8Pending, _LED_PENDING_ALL, stAppLED_Config.u8NbStrips * sizeof(uint8_t));
+            memset(pstAppLed_Params, 0, stAppLED_Config.u8NbStrips * sizeof(TstAppLed_Params));
+            memset(stAppLED_Config.pu32Power, 0, stAppLED_Config.u8NbStrips * sizeof(uint32_t));
+            TstLedOutput_Port tstPorts[LED_OUTPUT_MAX];
+            uint8_t u8NbPorts = u8AppLed_LoadOutputs(tstPorts, stAppLED_Config.u16NbLeds);
+            pLedOutput = pLedOutput_GetDriver();
+            if (pLedOutput->peInit(ledStrip, tstPorts, u8NbPorts) < eRet_Ok)
+            {
+                APP_TRACE("[AppLED_init] output layout rejected, single output\r\n");
+                tstPorts[0].u8Pin = LED_DATA_PIN;
+                tstPorts[0].u16NbLeds = stAppLED_Config.u16NbLeds;
+                u8NbPorts = 1;
+                pLedOutput->peInit(ledStrip, tstPorts, u8NbPorts);
+            }
+            snprintf(tcPrint, PRINT_UTILS_MAX_BUF, "[AppLED_init] %s output, %u port(s), %u us/frame, %u fps max\r\n",
+                pLedOutput->pcName, u8NbPorts, pLedOutput->pu32GetWireUs(), u16LedOutput_GetMaxFps());
+            APP_TRACE(tcPrint);
+            // brightness, balance and gamma are applied by the output table while composing
+            FastLED.setBrightness(255);
+            FastLED.setCorrection(UncorrectedColor);
+            FastLED.setDither(DISABLE_DITHER);
+            tAppLed_Luts[u8AppLed_Lut].vSetGamma(u16AppLed_Gamma100);
+            tAppLed_Luts[u8AppLed_Lut].vBuild(CRGB(u32AppLed_Balance), stAppLed_Power.u8Brightness);
+            u8AppLed_LutRev = u8AppLed_OutputRev;
+            memset(ledStrip, 0, stAppLED_Config.u16NbLeds * sizeof(CRGB));
+            pLedOutput->pvShow();
+            MyColorPalette1.eLoad(tMyColors1, sizeof(tMyColors1) / sizeof(CRGB));
             TstConfig *pstConfig = (TstConfig *)AnimationConfig;
             SubStrip *pObj = SubStrips;
             for (uint8_t i = 0; i < stAppLED_Config.u8NbStrips; i++)
             {
-                pObj->eSetOffset(pstConfig->u8Offset);
+                pObj->eSetOffset(pstConfig->u16Offset);
                 pObj->eSetDirection(pstConfig->eDirection);
                 pObj->eSetFadeRate(pstConfig->u16MsFade);
                 if (pObj->eSetAnimation(pstConfig->eAnimation, pstConfig->pPalette, pstConfig->u32Period, pstConfig->u8Speed) < SubStrip::RET_OK)
@@ -178,6 +378,11 @@ void AppLED_init(void) {
                 // pstConfig++;
                 pObj++;
             }
+#if APP_TIMING
+            vAppTiming_Init();
+            snprintf(tcPrint, PRINT_UTILS_MAX_BUF, "[AppLED_init] timing probe overhead: %u ns\r\n", u32AppTiming_GetOverheadNs());
+            APP_TRACE(tcPrint);
+#endif
             bStartTasking = true;
 
         }
@@ -190,18 +395,21 @@ void AppLED_init(void) {
 #if APP_TASKS
     if (bStartTasking)
     {
-        xLedStripSema = xSemaphoreCreateBinary();
-        if (xLedStripSema == NULL)
-        {
-            APP_TRACE("[AppLED_init] xLedStripSema create failed\r\n");
-        }
-        else
-        {
-            xSemaphoreGive(xLedStripSema);
-            xTaskCreate(vAppLedsTask, LED_TASK, LED_TASK_HEAP, LED_TASK_PARAM, LED_TASK_PRIO, LED_TASK_HANDLE);
-            snprintf(tcPrint, PRINT_UTILS_MAX_BUF, "[AppLED_init] Run task!\r\nFree heap: %u\r\n", ESP.getFreeHeap());
-            APP_TRACE(tcPrint);
-        }
+        xTaskCreatePinnedToCore(vAppLedsTxTask, LED_TX_TASK, LED_TX_TASK_HEAP, LED_TX_TASK_PARAM, LED_TX_TASK_PRIO, &xAppLed_TxTask, LED_TX_TASK_CORE);
+        xTaskCreatePinnedToCore(vAppLedsTask, LED_TASK, LED_TASK_HEAP, LED_TASK_PARAM, LED_TASK_PRIO, &xAppLed_Task, LED_TASK_CORE);
+        uint8_t u8Steps = u8AppLed_LoadPlaylist();
+        if (u8Steps >= 2)
+        { xTaskCreate(vAppLedsAnimTask, ANIM_TASK, ANIM_TASK_HEAP, ANIM_TASK_PARAM, ANIM_TASK_PRIO, &xAppLed_AnimTask); }
+        else if (u8Steps)
+        { vAppLed_PostStep(0); } // nothing to sequence
+        if (u8AppLed_LoadTimeslots())
+        { xTaskCreate(vAppLedsScheduleTask, SCHED_TASK, SCHED_TASK_HEAP, SCHED_TASK_PARAM, SCHED_TASK_PRIO, NULL); }
+#if APP_REALTIME
+        if (bAppLed_LoadRealtime())
+        { xTaskCreate(vAppLedsRealtimeTask, RT_TASK, RT_TASK_HEAP, RT_TASK_PARAM, RT_TASK_PRIO, &xAppLed_RtTask); }
+#endif
+        snprintf(tcPrint, PRINT_UTILS_MAX_BUF, "[AppLED_init] Run task!\r\nFree heap: %u\r\n", ESP.getFreeHeap());
+        APP_TRACE(tcPrint);
     }
 #endif
 }
@@ -212,358 +420,1541 @@ void AppLED_init(void) {
  ******************************************************************************/
 void vAppLedsTask(void *pvParam)
 {
-    char tcPrint[PRINT_UTILS_MAX_BUF] = {0};
+    (void)pvParam;
     TickType_t xLastWakeTime = xTaskGetTickCount();
     TickType_t xTaskPeriod = pdMS_TO_TICKS(_LED_TIMEOUT);
+    TickType_t xBlockTicks; // wait for a notification instead of a period, 0: periodic
     uint32_t u32Now;
+    uint32_t u32LastShow = 0;
+    uint32_t u32LoopUs;
+    uint32_t u32BusyUs;
+    TeAppLed_CpuState eCpuState;
+    bool bIdle = false; // frames stopped changing, one last frame was sent
+    bool bRealtime = false; // LEDSTRIP_FIXED entered, the realtime input owns the back buffer
+    bool bDark = false; // black frame sent by LEDSTRIP_BLACKOUT, the output is off
+    uint8_t u8RtLast = _LED_NO_FRAME; // last realtime frame published, settled
+#if APP_TIMING
+    uint32_t u32WakeUs = 0; // requested wake-up, 0 when not sleeping for a deadline
+#endif
     while (1)
     {
-        switch (eAppLed_CurrentState)
+        u32LoopUs = micros();
+        xBlockTicks = 0;
+#if APP_TIMING
+        if (u32WakeUs)
+        {
+            int32_t i32LateUs = (int32_t)(micros() - u32WakeUs);
+            vAppTiming_Record(eTiming_Jitter, (i32LateUs > 0) ? ((uint32_t)i32LateUs * 1000) : 0);
+            u32WakeUs = 0;
+        }
+#endif
+        TeAppLED_LedstripStates eState = bAppLed_Asleep ? LEDSTRIP_BLACKOUT : eAppLed_CurrentState;
+#if APP_REALTIME
+        if (bRealtime && (eState != LEDSTRIP_FIXED))
+        {
+            vAppLed_LeaveRealtime();
+            bRealtime = false;
+        }
+#endif
+        if (bDark && ((eState == LEDSTRIP_RUN) || (eState == LEDSTRIP_FIXED)))
+        {
+            // leaving a blackout or a sleep: fade in
+            bDark = false;
+            xTaskPeriod = 1;
+            u32AppLed_RampStart = millis();
+            u8AppLed_Ramp = 0;
+        }
+        switch (eState)
         {
         case LEDSTRIP_BLACKOUT:
-            xTaskPeriod = pdMS_TO_TICKS(100);
-            FastLED.clear();
-            FastLED.show();
+            eCpuState = bAppLed_Asleep ? eLedCpu_Asleep : eLedCpu_Blackout;
+            if (!bDark)
+            {
+                memset(stAppLED_Config.tpOutBuffers[stAppLED_Config.u8Back], 0, stAppLED_Config.u16NbLeds * sizeof(CRGB));
+                vAppLed_PublishFrame();
+                // front buffer is lost, compose everything again on resume
+                memset(stAppLED_Config.pu8Pending, _LED_PENDING_ALL, stAppLED_Config.u8NbStrips * sizeof(uint8_t));
+                bAppLed_ForceShow = true;
+                bIdle = false;
+                bDark = true;
+            }
+            // black frame sent once, nothing to do until a resume or a wake-up:
+            // the task blocks and the CPU may idle
+            xBlockTicks = portMAX_DELAY;
             break;
 
         case LEDSTRIP_STANDBY:
+            eCpuState = eLedCpu_Standby;
             xTaskPeriod = pdMS_TO_TICKS(100);
             // freeze ledstrip
             break;
 
         case LEDSTRIP_RUN:
-        if (LOCK_LEDS())
         {
-            xTaskPeriod = pdMS_TO_TICKS(_LED_TIMEOUT); //update task period
+            TIMING_START(u32FrameStart);
+            vAppLed_LatchParams(); // posted parameters, never waits for writers
+            bool bChanged = false;
+            uint8_t u8BackMask = (1 << stAppLED_Config.u8Back);
             u32Now = millis();
+            vAppLed_StepRamp(u32Now);
+            uint32_t u32Wake = u32Now + _LED_MAX_SLEEP;
             SubStrip *pObj = SubStrips;
-            // manage substrip operation
+            CRGB *pOut = stAppLED_Config.tpOutBuffers[stAppLED_Config.u8Back];
+            uint8_t *pu8Pending = stAppLED_Config.pu8Pending;
+            // earliest deadline first: animate due substrips only, then compose changed ones
+            // (rotation applied) into the back buffer
             for (uint8_t u8Sub = 0; u8Sub < stAppLED_Config.u8NbStrips; u8Sub++)
             {
-                pObj->vManageAnimation(u32Now);
+                if (pObj->bIsDue(u32Now))
+                {
+#if APP_TIMING
+                    uint32_t u32Due = pObj->u32GetDeadline();
+                    if (u32Due && !bIdle && ((int32_t)(u32Now - u32Due) >= pObj->u16GetFramePeriod()))
+                    { vAppTiming_CountMiss(); } // a whole frame late, one step is lost
+#endif
+                    TIMING_START(u32AnimStart);
+                    pObj->vManageAnimation(u32Now);
+                    TIMING_STOP(eTiming_Anim, u32AnimStart);
+                }
+                if ((int32_t)(pObj->u32GetDeadline() - u32Wake) < 0)
+                {
+                    u32Wake = pObj->u32GetDeadline();
+                }
+                if (pObj->bIsDirty())
+                {
+                    pObj->vClearDirty();
+                    *pu8Pending = _LED_PENDING_ALL;
+                    bChanged = true;
+                }
+                if (*pu8Pending & u8BackMask)
+                {
+                    vAppLed_ComposeStrip(u8Sub, pOut, u8BackMask);
+                }
+                pOut += stAppLED_Config.pu16Strips[u8Sub];
+                pu8Pending++;
                 pObj++;
             }
-            memcpy(ledStrip, stAppLED_Config.pSubstripAssemly, stAppLED_Config.u16NbLeds * sizeof(CRGB));
-            FastLED.show();
-            UNLOCK_LEDS();
+
+            // static output: no effect will change a pixel for a while
+            uint32_t u32Idle = 0;
+            if (!bChanged && !bAppLed_ForceShow && (u8AppLed_Ramp == 255))
+            { u32Idle = u32AppLed_IdleMs(u32Now); }
+            bool bWasIdle = bIdle;
+            bIdle = (u32Idle >= LED_IDLE_MIN_MS);
+            if (bChanged || bAppLed_ForceShow)
+            {
+                // hand the composed frame to the transmit task, render goes on meanwhile
+                bAppLed_ForceShow = false;
+                vAppLed_SettleOutput(); // brightness and gamma are in the pixels
+                vAppLed_PublishFrame();
+                u32LastShow = u32Now;
+            }
+            else if ((bIdle && !bWasIdle) ||
+                     (u16AppLed_KeepAliveMs && ((u32Now - u32LastShow) >= u16AppLed_KeepAliveMs)))
+            {
+                // unchanged frame, refresh the front buffer as is: keep-alive,
+                // or final frame before the render blocks
+                vAppLed_RequestShow();
+                u32LastShow = u32Now;
+            }
+            else
+            {
+                stAppLed_Counters.u32Skipped++;
+                stAppLed_Counters.u32BusTimeSavedMs = (uint32_t)(((uint64_t)stAppLed_Counters.u32Skipped * pLedOutput->pu32GetWireUs()) / 1000);
+            }
+            if (bIdle)
+            {
+                // block until the next effect event, the keep-alive or a
+                // command (vAppLed_Wake), whichever comes first
+                eCpuState = eLedCpu_Idle;
+                if (u16AppLed_KeepAliveMs)
+                {
+                    uint32_t u32KeepAlive = u32LastShow + u16AppLed_KeepAliveMs - u32Now;
+                    u32Idle = (u32KeepAlive < u32Idle) ? u32KeepAlive : u32Idle;
+                }
+                if (u32Idle == SUBSTRIP_IDLE_FOREVER)
+                { xBlockTicks = portMAX_DELAY; }
+                else
+                {
+                    xBlockTicks = pdMS_TO_TICKS((u32Idle < _LED_MAX_IDLE) ? u32Idle : _LED_MAX_IDLE);
+                    xBlockTicks = xBlockTicks ? xBlockTicks : 1;
+                }
+            }
+            else
+            {
+                eCpuState = eLedCpu_Run;
+                if (u16AppLed_KeepAliveMs && ((int32_t)(u32LastShow + u16AppLed_KeepAliveMs - u32Wake) < 0))
+                {
+                    u32Wake = u32LastShow + u16AppLed_KeepAliveMs;
+                }
+                // sleep until the earliest deadline, at least one tick
+                xTaskPeriod = ((int32_t)(u32Wake - u32Now) > 0) ? pdMS_TO_TICKS(u32Wake - u32Now) : 0;
+                xTaskPeriod = xTaskPeriod ? xTaskPeriod : 1;
+            }
+            TIMING_STOP(eTiming_Frame, u32FrameStart);
+#if APP_TIMING
+            if (!bIdle)
+            {
+                int32_t i32SleepMs = (int32_t)(u32Wake - millis());
+                u32WakeUs = micros() + ((i32SleepMs > 0) ? (i32SleepMs * 1000) : 0);
+                u32WakeUs = u32WakeUs ? u32WakeUs : 1;
+            }
+#endif
         }
         break;
 
         case LEDSTRIP_FIXED:
-            break;
+        {
+            eCpuState = eLedCpu_Fixed;
+#if APP_REALTIME
+            CRGB *pBack = stAppLED_Config.tpOutBuffers[stAppLED_Config.u8Back];
+            if (!bRealtime)
+            {
+                bRealtime = true;
+                bIdle = false;
+                u8RtLast = _LED_NO_FRAME;
+            }
+            // payloads are received straight into the back buffer until a
+            // frame completes, commands are checked at least every poll
+            u32Now = millis();
+            vAppLed_StepRamp(u32Now);
+            Realtime::TeEvent eEvent;
+            do
+            {
+                eEvent = xAppLed_Realtime.eReceive((uint8_t *)pBack, millis(), _LED_RT_POLL_MS);
+            } while ((eEvent == Realtime::EVENT_PACKET) && ((millis() - u32Now) < _LED_RT_POLL_MS));
+            if (eEvent == Realtime::EVENT_FRAME)
+            {
+                // the last published frame is never the back buffer
+                vAppLed_SettleRealtime(pBack, (u8RtLast != _LED_NO_FRAME) ? stAppLED_Config.tpOutBuffers[u8RtLast] : nullptr);
+                u8RtLast = stAppLED_Config.u8Back;
+                vAppLed_PublishFrame();
+            }
+            else if (!xAppLed_Realtime.bIsActive(millis()))
+            {
+                // the source went silent: back to the local animations, unless
+                // a command changed the state meanwhile
+                bAppLed_SwapState(LEDSTRIP_FIXED, LEDSTRIP_RUN);
+            }
+            xLastWakeTime = xTaskGetTickCount();
+            xTaskPeriod = 1;
+#endif
+        }
+        break;
 
         default:
+            eCpuState = eLedCpu_Standby;
             break;
         }
-        vTaskDelayUntil(&xLastWakeTime, xTaskPeriod);
+        u32BusyUs = micros() - u32LoopUs;
+        if (xBlockTicks)
+        {
+            // woken by vAppLed_Wake() or the timeout, the period grid restarts
+            ulTaskNotifyTake(pdTRUE, xBlockTicks);
+            xLastWakeTime = xTaskGetTickCount();
+        }
+        else
+        {
+            vTaskDelayUntil(&xLastWakeTime, xTaskPeriod);
+        }
+        vAppLed_CountCpu(eCpuState, u32BusyUs, micros() - u32LoopUs);
     } // end task loop
 }
 
 /*******************************************************************************
- * @brief AppLeds animation change task
- * 
+ * @brief AppLeds transmit task
+ * @details Takes the ready frame, if any, and transmits it. Without a new
+ *          frame, a notification transmits the front buffer again (keep-alive).
+ *          Runs on its own core: the wire time of frame N overlaps the render
+ *          of frame N + 1.
  ******************************************************************************/
-void vAppLedsAnimTask(void *pvParam) {
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-    SubStrip *pObj;
-    char tcDbgString[PRINT_UTILS_MAX_BUF] = {0};
-    while (1) {
-        vTaskDelayUntil( &xLastWakeTime, pdMS_TO_TICKS(LED_CHANGE_DELAY));
+void vAppLedsTxTask(void *pvParam)
+{
+    (void)pvParam;
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        bool bNewFrame = false;
+        portENTER_CRITICAL(&xAppLed_BufferMux);
+        if (stAppLED_Config.u8Ready != _LED_NO_FRAME)
+        {
+            // the former front buffer is free once this one is on the wire
+            stAppLED_Config.u8Front = stAppLED_Config.u8Ready;
+            stAppLED_Config.u8Ready = _LED_NO_FRAME;
+            bNewFrame = true;
+        }
+        portEXIT_CRITICAL(&xAppLed_BufferMux);
 
-        if(LOCK_LEDS()) {
-            // protected ressource >>>
-            snprintf(tcDbgString, PRINT_UTILS_MAX_BUF, "[APP_ANIM] [%u] Animation event\r\n", millis());
-            APP_TRACE(tcDbgString);
-            // <<< end of protected ressource
-            UNLOCK_LEDS();
+        if (bNewFrame)
+        {
+            ledStrip = stAppLED_Config.tpOutBuffers[stAppLED_Config.u8Front];
+            pLedOutput->pvSetLeds(ledStrip);
+            stAppLed_Counters.u32Shown++;
+        }
+        else
+        {
+            stAppLed_Counters.u32KeepAlive++;
         }
+        TIMING_START(u32ShowStart);
+        pLedOutput->pvShow();
+        TIMING_STOP(eTiming_Show, u32ShowStart);
     }
 }
 
-eApp_RetVal eAppLed_blackout(void) {
-    eAppLed_CurrentState = LEDSTRIP_BLACKOUT;
-    return eRet_Ok;
+/*******************************************************************************
+ * @brief Hand the back buffer to the transmit task
+ * @details No pixel is copied. The back buffer becomes the ready one; the
+ *          next back buffer is the former ready frame if it was not taken yet
+ *          (that frame is dropped, the newest wins), else the free buffer.
+ *          Only called from vAppLedsTask.
+ ******************************************************************************/
+static void vAppLed_PublishFrame(void)
+{
+    portENTER_CRITICAL(&xAppLed_BufferMux);
+    uint8_t u8Prev = stAppLED_Config.u8Ready;
+    stAppLED_Config.u8Ready = stAppLED_Config.u8Back;
+    if (u8Prev != _LED_NO_FRAME)
+    {
+        stAppLED_Config.u8Back = u8Prev;
+        stAppLed_Counters.u32Dropped++;
+    }
+    else
+    {
+        // the three indexes are distinct: 0 + 1 + 2
+        stAppLED_Config.u8Back = (0 + 1 + 2) - stAppLED_Config.u8Front - stAppLED_Config.u8Ready;
+    }
+    portEXIT_CRITICAL(&xAppLed_BufferMux);
+    vAppLed_RequestShow();
 }
 
-eApp_RetVal eAppLed_resume(void) {
-    eAppLed_CurrentState = LEDSTRIP_RUN;
-    return eRet_Ok;
+/*******************************************************************************
+ * @brief Wake the transmit task: ready frame, or front buffer again
+ ******************************************************************************/
+static void vAppLed_RequestShow(void)
+{
+    xTaskNotifyGive(xAppLed_TxTask);
 }
 
-eApp_RetVal eAppLed_SetBrightness(uint8_t u8Value) {
-    FastLED.setBrightness(u8Value);
-    return eRet_Ok;
+#if APP_REALTIME
+/*******************************************************************************
+ * @brief Read DEVICE_REALTIME: {"DDP_PORT":4048,"E131_PORT":5568,
+ *        "UNIVERSE":1,"TIMEOUT":2500}, a null port disables its protocol
+ * @return true if an input is configured
+ ******************************************************************************/
+static bool bAppLed_LoadRealtime(void)
+{
+    char tcPrint[PRINT_UTILS_MAX_BUF];
+    bAppCfg_LockJson();
+    JsonObject jRealtime = jAppCfg_Config["DEVICE_REALTIME"].as<JsonObject>();
+    uint16_t u16DdpPort = jRealtime["DDP_PORT"] | REALTIME_DDP_PORT;
+    uint16_t u16E131Port = jRealtime["E131_PORT"] | REALTIME_E131_PORT;
+    uint16_t u16Universe = jRealtime["UNIVERSE"] | 1;
+    uint16_t u16TimeoutMs = jRealtime["TIMEOUT"] | REALTIME_TIMEOUT_MS;
+    bAppCfg_UnlockJson();
+    bool bEnabled = (xAppLed_Realtime.eConfigure(u16DdpPort, u16E131Port, u16Universe, stAppLED_Config.u16NbLeds * sizeof(CRGB)) == Realtime::RET_OK);
+    xAppLed_Realtime.eSetTimeout(u16TimeoutMs);
+    snprintf(tcPrint, PRINT_UTILS_MAX_BUF, "[AppLED_init] realtime input: %s, DDP %u, E1.31 %u from universe %u\r\n",
+        bEnabled ? "on" : "off", u16DdpPort, u16E131Port, u16Universe);
+    APP_TRACE(tcPrint);
+    return bEnabled;
 }
 
-eApp_RetVal eAppLed_SetAnimation(SubStrip::TeAnimation eAnimation, uint8_t u8Index) {
-    eApp_RetVal eRet = eRet_Ok;
-    if (eAnimation >= SubStrip::NB_ANIMS) {
-        eRet = eRet_BadParameter;
+/*******************************************************************************
+ * @brief Pass a received frame through the output stage, in place
+ * @details The frame is not composed: the table, settled to the target
+ *          brightness, is applied to the bytes received for this frame only.
+ *          The others hold an older frame of the rotation, already settled:
+ *          they are copied from the last published frame, black without one.
+ *          Over the power budget, the received bytes are scaled down to fit
+ *          next to the copied ones, which were limited with their own frame.
+ * @param pFrame back buffer, received into
+ * @param pLast last published realtime frame, nullptr if none
+ ******************************************************************************/
+static void vAppLed_SettleRealtime(CRGB *pFrame, const CRGB *pLast)
+{
+    uint8_t u8Brightness = u8AppLed_TargetBrightness();
+    uint8_t u8Rev = u8AppLed_OutputRev;
+    if ((u8Brightness != tAppLed_Luts[u8AppLed_Lut].u8GetBrightness()) || (u8Rev != u8AppLed_LutRev))
+    {
+        OutputLut *pSpare = &tAppLed_Luts[u8AppLed_Lut ^ 1];
+        if (pSpare->u16GetGamma() != u16AppLed_Gamma100)
+        { pSpare->vSetGamma(u16AppLed_Gamma100); }
+        pSpare->vBuild(CRGB(u32AppLed_Balance), u8Brightness);
+        u8AppLed_Lut ^= 1;
+        u8AppLed_LutRev = u8Rev;
     }
-    else if (LOCK_LEDS()) {
-        SubStrip *pObj = NULL;
-        if (u8Index != _LED_ALLSTRIPS) {
-            pObj = &SubStrips[u8Index];
-            eRet = (pObj->eSetAnimation(eAnimation) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
+    const OutputLut *pLut = &tAppLed_Luts[u8AppLed_Lut];
+    const Realtime::TstRange *pstRanges;
+    uint8_t u8NbRanges = xAppLed_Realtime.u8GetFrameRanges(&pstRanges);
+    uint8_t *pu8Frame = (uint8_t *)pFrame;
+    uint32_t u32Bytes = stAppLED_Config.u16NbLeds * sizeof(CRGB);
+    uint32_t tu32Channels[3] = {0, 0, 0}; // received bytes, settled
+    uint32_t u32End = 0;
+    for (uint8_t u8Range = 0; u8Range <= u8NbRanges; u8Range++)
+    {
+        // gap before the range (after the last one: up to the end), then the range
+        uint32_t u32Offset = (u8Range < u8NbRanges) ? pstRanges[u8Range].u32Offset : u32Bytes;
+        if (u32Offset > u32End)
+        {
+            if (pLast != nullptr)
+            { memcpy(pu8Frame + u32End, (const uint8_t *)pLast + u32End, u32Offset - u32End); }
+            else
+            { memset(pu8Frame + u32End, 0, u32Offset - u32End); }
         }
-        else {
-            pObj = SubStrips;
-            for (uint8_t i = 0; (i < stAppLED_Config.u8NbStrips) && (eRet >= eRet_Ok); i++) {
-                eRet = (pObj->eSetAnimation(eAnimation) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-                pObj++;
-            }
+        if (u8Range == u8NbRanges)
+        { break; }
+        u32End = u32Offset + pstRanges[u8Range].u32Length;
+        for (uint32_t i = u32Offset; i < u32End; i++)
+        {
+            uint8_t u8Channel = i % 3;
+            pu8Frame[i] = pLut->u8Apply(u8Channel, pu8Frame[i]);
+            tu32Channels[u8Channel] += pu8Frame[i];
         }
-        UNLOCK_LEDS();
-    }
-    return eRet;
-}
-
-eApp_RetVal eAppLed_SetSpeed(uint8_t u8Speed, uint8_t u8Index) {
-    eApp_RetVal eRet = eRet_Ok;
-    if ((u8Index >= stAppLED_Config.u8NbStrips) && (u8Index != _LED_ALLSTRIPS)) {
-        eRet = eRet_BadParameter;
     }
-    else if (LOCK_LEDS()) {
-        SubStrip *pObj = NULL;
-        if (u8Index != _LED_ALLSTRIPS) {
-            pObj = &SubStrips[u8Index];
-            eRet = (pObj->eSetSpeed(u8Speed) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-        }
-        else {
-            pObj = SubStrips;
-            for (uint8_t i = 0; (i < stAppLED_Config.u8NbStrips) && (eRet >= eRet_Ok); i++) {
-                eRet = (pObj->eSetSpeed(u8Speed) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-                pObj++;
+    uint32_t u32IdleMa = (uint32_t)stAppLED_Config.u16NbLeds * LED_OUTPUT_MA_IDLE;
+    uint32_t u32Sum = u32AppLed_StripPower(pFrame, stAppLED_Config.u16NbLeds);
+    uint32_t u32Received = (tu32Channels[0] * LED_OUTPUT_MA_RED) + (tu32Channels[1] * LED_OUTPUT_MA_GREEN) + (tu32Channels[2] * LED_OUTPUT_MA_BLUE);
+    uint32_t u32Copied = u32Sum - u32Received;
+    uint8_t u8Scale = 255;
+    stAppLed_Power.u32EstimatedMa = u32IdleMa + (u32Sum / 255);
+    if (stAppLed_Power.u32BudgetMa && u32Sum && (stAppLed_Power.u32EstimatedMa > stAppLed_Power.u32BudgetMa))
+    {
+        uint32_t u32Room = (stAppLed_Power.u32BudgetMa > u32IdleMa) ? (stAppLed_Power.u32BudgetMa - u32IdleMa) : 0;
+        uint64_t u64Room = (uint64_t)u32Room * 255; // channel sum the budget leaves
+        if (u32Received && (u32Copied < u64Room))
+        {
+            u8Scale = (uint8_t)(((u64Room - u32Copied) * 255) / u32Received);
+            for (uint8_t u8Range = 0; u8Range < u8NbRanges; u8Range++)
+            {
+                uint8_t *pu8 = pu8Frame + pstRanges[u8Range].u32Offset;
+                for (uint32_t i = 0; i < pstRanges[u8Range].u32Length; i++)
+                { pu8[i] = (uint8_t)((pu8[i] * ((uint32_t)u8Scale + 1)) >> 8); } // as vKernel_Scale()
             }
+            u32Sum = u32Copied + (uint32_t)(((uint64_t)u32Received * u8Scale) / 255);
+        }
+        else
+        {
+            // budget lowered under the copied bytes alone: the whole frame, once
+            u8Scale = (uint8_t)((u64Room * 255) / u32Sum);
+            vKernel_Scale(pFrame, stAppLED_Config.u16NbLeds, u8Scale);
+            u32Sum = (uint32_t)(((uint64_t)u32Sum * u8Scale) / 255);
         }
-        UNLOCK_LEDS();
+        stAppLed_Power.u32LimitedFrames++;
     }
-    return eRet;
+    stAppLed_Power.u8Applied = (uint8_t)(((uint16_t)u8Brightness * u8Scale) / 255);
+    stAppLed_Power.u32DrawnMa = u32IdleMa + (u32Sum / 255);
+    stAppLed_Power.u32PeakMa = (stAppLed_Power.u32DrawnMa > stAppLed_Power.u32PeakMa) ? stAppLed_Power.u32DrawnMa : stAppLed_Power.u32PeakMa;
 }
 
-eApp_RetVal eAppLed_SetPeriod(uint32_t u32Period, uint8_t u8Index) {
-    eApp_RetVal eRet = eRet_Ok;
-    if ((u8Index >= stAppLED_Config.u8NbStrips) && (u8Index != _LED_ALLSTRIPS)) {
-        eRet = eRet_BadParameter;
-    }
-    else if (LOCK_LEDS()) {
-        SubStrip *pObj = NULL;
-        if (u8Index != _LED_ALLSTRIPS) {
-            pObj = &SubStrips[u8Index];
-            eRet = (pObj->eSetPeriod(u32Period) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-        }
-        else {
-            pObj = SubStrips;
-            for (uint8_t i = 0; (i < stAppLED_Config.u8NbStrips) && (eRet >= eRet_Ok); i++) {
-                eRet = (pObj->eSetPeriod(u32Period) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-                pObj++;
-            }
-        }
-        UNLOCK_LEDS();
-    }
-    return eRet;
+/*******************************************************************************
+ * @brief Give the output back to the local animations, render task only
+ * @details The realtime frames replaced the composed ones in every buffer:
+ *          all substrips are composed again. The realtime task waits for
+ *          a stream again.
+ ******************************************************************************/
+static void vAppLed_LeaveRealtime(void)
+{
+    xAppLed_Realtime.vRelease();
+    memset(stAppLED_Config.pu8Pending, _LED_PENDING_ALL, stAppLED_Config.u8NbStrips * sizeof(uint8_t));
+    bAppLed_ForceShow = true;
+    if (xAppLed_RtTask != NULL)
+    { xTaskNotifyGive(xAppLed_RtTask); }
 }
 
-eApp_RetVal eAppLed_SetFade(uint16_t u16FadeMs, uint8_t u8Index) {
-    eApp_RetVal eRet = eRet_Ok;
-    if ((u8Index >= stAppLED_Config.u8NbStrips) && (u8Index != _LED_ALLSTRIPS)) {
-        eRet = eRet_BadParameter;
-    }
-    else if (LOCK_LEDS()) {
-        SubStrip *pObj = NULL;
-        if (u8Index != _LED_ALLSTRIPS) {
-            pObj = &SubStrips[u8Index];
-            eRet = (pObj->eSetFadeRate(u16FadeMs) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-        }
-        else {
-            pObj = SubStrips;
-            for (uint8_t i = 0; (i < stAppLED_Config.u8NbStrips) && (eRet >= eRet_Ok); i++) {
-                eRet = (pObj->eSetFadeRate(u16FadeMs) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-                pObj++;
-            }
-        }
-        UNLOCK_LEDS();
-    }
-    return eRet;
+/*******************************************************************************
+ * @brief Hand the output between the realtime input and the local animations
+ * @details Compare and swap: a blackout or a standby set by a command in
+ *          between is never overwritten.
+ * @return true if the state was eFrom and is now eTo
+ ******************************************************************************/
+static bool bAppLed_SwapState(TeAppLED_LedstripStates eFrom, TeAppLED_LedstripStates eTo)
+{
+    return __atomic_compare_exchange_n(&eAppLed_CurrentState, &eFrom, eTo, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
 }
 
-eApp_RetVal eAppLed_SetDirection(SubStrip::TeDirection eDirection, uint8_t u8Index) {
-    eApp_RetVal eRet = eRet_Ok;
-    if ((u8Index >= stAppLED_Config.u8NbStrips) && (u8Index != _LED_ALLSTRIPS)) {
-        eRet = eRet_BadParameter;
+/*******************************************************************************
+ * @brief AppLeds realtime input task
+ * @details Blocks on the sockets while the local animations run. The first
+ *          valid packet switches the render to LEDSTRIP_FIXED, which then
+ *          reads the sockets itself; this task waits until the render is
+ *          back to the local animations. Blackout, standby and sleep are not
+ *          overridden, their packets are dropped.
+ ******************************************************************************/
+void vAppLedsRealtimeTask(void *pvParam)
+{
+    (void)pvParam;
+    while (WiFi.status() != WL_CONNECTED)
+    { vTaskDelay(pdMS_TO_TICKS(1000)); }
+    if (xAppLed_Realtime.eOpen() != Realtime::RET_OK)
+    {
+        APP_TRACE("[APP_RT] socket error, realtime input off\r\n");
+        xAppLed_Realtime.vClose();
+        xAppLed_RtTask = NULL;
+        vTaskDelete(NULL);
     }
-    else if (LOCK_LEDS()) {
-        SubStrip *pObj = NULL;
-        if (u8Index != _LED_ALLSTRIPS) {
-            pObj = &SubStrips[u8Index];
-            eRet = (pObj->eSetDirection(eDirection) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-        }
-        else {
-            pObj = SubStrips;
-            for (uint8_t i = 0; (i < stAppLED_Config.u8NbStrips) && (eRet >= eRet_Ok); i++) {
-                eRet = (pObj->eSetDirection(eDirection) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-                pObj++;
-            }
+    while (1)
+    {
+        if (!xAppLed_Realtime.bPoll(millis(), _LED_RT_WAIT_MS))
+        { continue; }
+        if (bAppLed_Asleep || !bAppLed_SwapState(LEDSTRIP_RUN, LEDSTRIP_FIXED))
+        {
+            xAppLed_Realtime.vDiscard();
+            continue;
         }
-        UNLOCK_LEDS();
+        vAppLed_Wake();
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // vAppLed_LeaveRealtime()
     }
-    return eRet;
 }
+#endif
 
-eApp_RetVal eAppLed_SetOffset(uint8_t u8Offset, uint8_t u8Index) {
-    eApp_RetVal eRet = eRet_Ok;
-    if ((u8Index >= stAppLED_Config.u8NbStrips) && (u8Index != _LED_ALLSTRIPS)) {
-        eRet = eRet_BadParameter;
-    }
-    else if (LOCK_LEDS()) {
-        SubStrip *pObj = NULL;
-        if (u8Index != _LED_ALLSTRIPS) {
-            pObj = &SubStrips[u8Index];
-            eRet = (pObj->eSetOffset(u8Offset) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-        }
-        else {
-            pObj = SubStrips;
-            for (uint8_t i = 0; (i < stAppLED_Config.u8NbStrips) && (eRet >= eRet_Ok); i++) {
-                eRet = (pObj->eSetOffset(u8Offset) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-                pObj++;
-            }
-        }
-        UNLOCK_LEDS();
+/*******************************************************************************
+ * @brief Wake the render out of an idle or blackout wait, after a command
+ ******************************************************************************/
+static void vAppLed_Wake(void)
+{
+    if (xAppLed_Task != NULL)
+    { xTaskNotifyGive(xAppLed_Task); }
+}
+
+/*******************************************************************************
+ * @brief Time the output will stay unchanged for, render task only
+ * @param u32Now current time in milliseconds
+ * @return shortest idle time of the sub-strips, SUBSTRIP_IDLE_FOREVER if static
+ ******************************************************************************/
+static uint32_t u32AppLed_IdleMs(uint32_t u32Now)
+{
+    uint32_t u32Idle = SUBSTRIP_IDLE_FOREVER;
+    for (uint8_t u8Sub = 0; u32Idle && (u8Sub < stAppLED_Config.u8NbStrips); u8Sub++)
+    {
+        uint32_t u32Sub = SubStrips[u8Sub].u32GetIdleMs(u32Now);
+        u32Idle = (u32Sub < u32Idle) ? u32Sub : u32Idle;
     }
-    return eRet;
+    return u32Idle;
 }
 
-eApp_RetVal eAppLed_SetBpm(uint8_t u8Bpm, uint8_t u8Index) {
-    eApp_RetVal eRet = eRet_Ok;
-    if ((u8Index >= stAppLED_Config.u8NbStrips) && (u8Index != _LED_ALLSTRIPS)) {
-        eRet = eRet_BadParameter;
+/*******************************************************************************
+ * @brief Account one render loop iteration to its state
+ * @param eState state the task waited in
+ * @param u32BusyUs time spent before the wait
+ * @param u32WallUs whole iteration, wait included
+ ******************************************************************************/
+static void vAppLed_CountCpu(TeAppLed_CpuState eState, uint32_t u32BusyUs, uint32_t u32WallUs)
+{
+    portENTER_CRITICAL(&xAppLed_CpuMux);
+    tAppLed_Cpu[eState].u64BusyUs += u32BusyUs;
+    tAppLed_Cpu[eState].u64WallUs += u32WallUs;
+    tAppLed_Cpu[eState].u32Wakes++;
+    portEXIT_CRITICAL(&xAppLed_CpuMux);
+}
+
+/*******************************************************************************
+ * @brief Read the output ports from DEVICE_OUTPUTS
+ * @details [{"PIN":4,"LEDS":300},{"PIN":5,"LEDS":0}]: ports take consecutive
+ *          pixels of the ledstrip, LEDS 0 takes what is left. The last port
+ *          always ends the ledstrip. Falls back to LED_DATA_PIN alone.
+ *          Reading stops at the first invalid or already used PIN.
+ * @param pstPorts LED_OUTPUT_MAX ports
+ * @param u16NbLeds length of the ledstrip
+ * @return number of ports
+ ******************************************************************************/
+static uint8_t u8AppLed_LoadOutputs(TstLedOutput_Port *pstPorts, uint16_t u16NbLeds)
+{
+    uint8_t u8NbPorts = 0;
+    uint16_t u16Left = u16NbLeds;
+    bAppCfg_LockJson();
+    JsonArray jOutputs = jAppCfg_Config["DEVICE_OUTPUTS"].as<JsonArray>();
+    for (JsonObject jPort : jOutputs)
+    {
+        uint8_t u8Pin = jPort["PIN"] | 0xFF;
+        uint16_t u16Leds = jPort["LEDS"] | 0;
+        if (!u16Left || (u8NbPorts >= LED_OUTPUT_MAX) || !bLedOutput_IsValidPin(u8Pin))
+        { break; }
+        uint8_t u8Used = 0;
+        while ((u8Used < u8NbPorts) && (pstPorts[u8Used].u8Pin != u8Pin))
+        { u8Used++; }
+        if (u8Used < u8NbPorts)
+        { break; } // one controller per pin
+        pstPorts[u8NbPorts].u8Pin = u8Pin;
+        pstPorts[u8NbPorts].u16NbLeds = (!u16Leds || (u16Leds > u16Left)) ? u16Left : u16Leds;
+        u16Left -= pstPorts[u8NbPorts].u16NbLeds;
+        u8NbPorts++;
     }
-    else if (LOCK_LEDS()) {
-        SubStrip *pObj = NULL;
-        if (u8Index != _LED_ALLSTRIPS) {
-            pObj = &SubStrips[u8Index];
-            eRet = (pObj->eSetBpm(u8Bpm) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-        }
-        else {
-            pObj = SubStrips;
-            for (uint8_t i = 0; (i < stAppLED_Config.u8NbStrips) && (eRet >= eRet_Ok); i++) {
-                eRet = (pObj->eSetBpm(u8Bpm) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-                pObj++;
-            }
-        }
-        UNLOCK_LEDS();
+    bAppCfg_UnlockJson();
+    if (!u8NbPorts)
+    {
+        pstPorts[0].u8Pin = LED_DATA_PIN;
+        pstPorts[0].u16NbLeds = u16NbLeds;
+        u8NbPorts = 1;
     }
-    return eRet;
+    else
+    { pstPorts[u8NbPorts - 1].u16NbLeds += u16Left; }
+    return u8NbPorts;
 }
 
-eApp_RetVal eAppLed_SetPalette(uint8_t u8PaletteIndex, uint8_t u8SubStripIndex) {
-    eApp_RetVal eRet = eRet_Ok;
-    if (((u8SubStripIndex >= stAppLED_Config.u8NbStrips) && (u8SubStripIndex != _LED_ALLSTRIPS)) || (u8PaletteIndex >= stAppLED_Config.u8NbStrips))
-    { eRet = eRet_BadParameter; }
-    else {
-        CRGB *pPalette = &tCustomPalettes[u8PaletteIndex][0];
-        SubStrip *pObj = NULL;
-
-        if (LOCK_LEDS()) {
-            if (u8SubStripIndex != _LED_ALLSTRIPS) {
-                pObj = &SubStrips[u8SubStripIndex];
-                eRet = (pObj->eSetColorPalette(pPalette) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-            }
-            else {
-                pObj = SubStrips;
-                for (uint8_t i = 0; (i < stAppLED_Config.u8NbStrips) && (eRet >= eRet_Ok); i++) {
-                    eRet = (pObj->eSetColorPalette(pPalette) < SubStrip::RET_OK) ? eRet_InternalError : eRet_Ok;
-                    pObj++;
-                }
-            }
-            UNLOCK_LEDS();
-        }
+/*******************************************************************************
+ * @brief Weighted channel sum of a composed substrip, full scale current in
+ *        mA * 255 (LED_OUTPUT_MA_* model)
+ ******************************************************************************/
+static uint32_t u32AppLed_StripPower(const CRGB *pLeds, uint16_t u16NbLeds)
+{
+    uint32_t u32Red = 0;
+    uint32_t u32Green = 0;
+    uint32_t u32Blue = 0;
+    for (uint16_t i = 0; i < u16NbLeds; i++)
+    {
+        u32Red += pLeds[i].r;
+        u32Green += pLeds[i].g;
+        u32Blue += pLeds[i].b;
     }
-    return eRet;
+    return (u32Red * LED_OUTPUT_MA_RED) + (u32Green * LED_OUTPUT_MA_GREEN) + (u32Blue * LED_OUTPUT_MA_BLUE);
 }
 
-eApp_RetVal eAppLed_LoadColorAt(CRGB xColor, uint8_t u8PaletteIndex, uint8_t u8Index) {
-    eApp_RetVal eRet = eRet_Ok;
-    if ((u8Index >= LED_STATIC_PALETTE_NB) || (u8PaletteIndex >= stAppLED_Config.u8NbStrips) || (xColor == CRGB::Black))
-    { eRet = eRet_BadParameter; }
-    else {
-        if (LOCK_LEDS()) {
-            tCustomPalettes[u8PaletteIndex][u8Index] = xColor;
-            UNLOCK_LEDS();
-        }
+/*******************************************************************************
+ * @brief Pick the brightness of the back buffer from its current estimate
+ * @details The estimate is kept up to date per composed substrip, with the
+ *          brightness of the active output table; it is only scaled here:
+ *          mA = idle + sum * brightness / (255 * table brightness). Over
+ *          budget, the brightness is lowered to fit, never raised above the
+ *          requested one.
+ * @param u8LutBrightness brightness the sum was measured with
+ * @return brightness to show the frame with
+ ******************************************************************************/
+static uint8_t u8AppLed_LimitPower(uint8_t u8LutBrightness)
+{
+    uint8_t u8Brightness = u8AppLed_TargetBrightness();
+    uint32_t u32IdleMa = (uint32_t)stAppLED_Config.u16NbLeds * LED_OUTPUT_MA_IDLE;
+    uint64_t u64Sum = stAppLED_Config.u32PowerSum;
+    if (!u8LutBrightness)
+    { return u8Brightness; } // nothing measured yet, try the requested one
+    stAppLed_Power.u32EstimatedMa = u32IdleMa + (uint32_t)((u64Sum * u8Brightness) / (255UL * u8LutBrightness));
+    if (stAppLed_Power.u32BudgetMa && u64Sum && (stAppLed_Power.u32EstimatedMa > stAppLed_Power.u32BudgetMa))
+    {
+        uint32_t u32Room = (stAppLed_Power.u32BudgetMa > u32IdleMa) ? (stAppLed_Power.u32BudgetMa - u32IdleMa) : 0;
+        uint64_t u64Fit = ((uint64_t)u32Room * 255 * u8LutBrightness) / u64Sum;
+        u8Brightness = (u64Fit < u8Brightness) ? (uint8_t)u64Fit : u8Brightness;
     }
-    return eRet;
+    return u8Brightness;
+}
+
+/*******************************************************************************
+ * @brief Compose one substrip into the back buffer through the output table
+ * @details The power estimate of the substrip is taken on its first
+ *          composition after a change only, the others are unchanged.
+ ******************************************************************************/
+static void vAppLed_ComposeStrip(uint8_t u8Sub, CRGB *pOut, uint8_t u8BackMask)
+{
+    uint8_t *pu8Pending = &stAppLED_Config.pu8Pending[u8Sub];
+    bool bFresh = (*pu8Pending == _LED_PENDING_ALL); // first composition since it changed
+    TIMING_START(u32ComposeStart);
+    SubStrips[u8Sub].eGetSubStrip(pOut, stAppLED_Config.pu16Strips[u8Sub], &tAppLed_Luts[u8AppLed_Lut]);
+    TIMING_STOP(eTiming_Compose, u32ComposeStart);
+    *pu8Pending &= ~u8BackMask;
+    if (bFresh)
+    {
+        uint32_t u32Power = u32AppLed_StripPower(pOut, stAppLED_Config.pu16Strips[u8Sub]);
+        stAppLED_Config.u32PowerSum += u32Power - stAppLED_Config.pu32Power[u8Sub];
+        stAppLED_Config.pu32Power[u8Sub] = u32Power;
+    }
+}
+
+/*******************************************************************************
+ * @brief Settle the output table of the back buffer before it is published
+ * @details A new brightness (power limit, ramp) or new gamma/balance settings
+ *          build the spare table, which is swapped in: no per-pixel math.
+ *          Every pixel then changes, the whole frame is composed again and
+ *          measured; a second round refines a limit taken from a stale sum.
+ ******************************************************************************/
+static void vAppLed_SettleOutput(void)
+{
+    uint8_t u8BackMask = (1 << stAppLED_Config.u8Back);
+    for (uint8_t u8Round = 0; u8Round < 2; u8Round++)
+    {
+        uint8_t u8Brightness = u8AppLed_LimitPower(tAppLed_Luts[u8AppLed_Lut].u8GetBrightness());
+        uint8_t u8Rev = u8AppLed_OutputRev;
+        if ((u8Brightness == tAppLed_Luts[u8AppLed_Lut].u8GetBrightness()) && (u8Rev == u8AppLed_LutRev))
+        { break; }
+        OutputLut *pSpare = &tAppLed_Luts[u8AppLed_Lut ^ 1];
+        if (pSpare->u16GetGamma() != u16AppLed_Gamma100)
+        { pSpare->vSetGamma(u16AppLed_Gamma100); }
+        pSpare->vBuild(CRGB(u32AppLed_Balance), u8Brightness);
+        u8AppLed_Lut ^= 1;
+        u8AppLed_LutRev = u8Rev;
+        memset(stAppLED_Config.pu8Pending, _LED_PENDING_ALL, stAppLED_Config.u8NbStrips * sizeof(uint8_t));
+        CRGB *pOut = stAppLED_Config.tpOutBuffers[stAppLED_Config.u8Back];
+        for (uint8_t u8Sub = 0; u8Sub < stAppLED_Config.u8NbStrips; u8Sub++)
+        {
+            vAppLed_ComposeStrip(u8Sub, pOut, u8BackMask);
+            pOut += stAppLED_Config.pu16Strips[u8Sub];
+        }
+    }
+    uint8_t u8Applied = tAppLed_Luts[u8AppLed_Lut].u8GetBrightness();
+    stAppLed_Power.u8Applied = u8Applied;
+    stAppLed_Power.u32DrawnMa = ((uint32_t)stAppLED_Config.u16NbLeds * LED_OUTPUT_MA_IDLE) + (stAppLED_Config.u32PowerSum / 255);
+    stAppLed_Power.u32PeakMa = (stAppLed_Power.u32DrawnMa > stAppLed_Power.u32PeakMa) ? stAppLed_Power.u32DrawnMa : stAppLed_Power.u32PeakMa;
+    if (u8Applied < u8AppLed_TargetBrightness())
+    { stAppLed_Power.u32LimitedFrames++; }
+}
+
+/*******************************************************************************
+ * @brief Requested brightness, scaled by the ramp after a blackout
+ ******************************************************************************/
+static uint8_t u8AppLed_TargetBrightness(void)
+{
+    return (uint8_t)(((uint16_t)stAppLed_Power.u8Brightness * (u8AppLed_Ramp + 1)) >> 8);
+}
+
+/*******************************************************************************
+ * @brief Advance the brightness ramp, render task only
+ ******************************************************************************/
+static void vAppLed_StepRamp(uint32_t u32Now)
+{
+    if (u8AppLed_Ramp < 255)
+    {
+        uint32_t u32Elapsed = u32Now - u32AppLed_RampStart;
+        u8AppLed_Ramp = (u32Elapsed < LED_WAKE_FADE_MS) ? (uint8_t)((u32Elapsed * 255) / LED_WAKE_FADE_MS) : 255;
+        bAppLed_ForceShow = true; // the frame brightens even if its pixels do not change
+    }
+}
+
+/*******************************************************************************
+ * @brief Compile DEVICE_PROG_ANIM into the playlist
+ * @details [{"ANIM":"glitter","DURATION":120,"XFADE":1500}]: animation name,
+ *          duration in seconds, optional crossfade in ms (LED_XFADE_MS).
+ *          Unknown animations and null durations are skipped.
+ * @return number of steps
+ ******************************************************************************/
+static uint8_t u8AppLed_LoadPlaylist(void)
+{
+    char tcPrint[PRINT_UTILS_MAX_BUF];
+    u8AppLed_PlaylistLen = 0;
+    bAppCfg_LockJson();
+    JsonArray jProg = jAppCfg_Config["DEVICE_PROG_ANIM"].as<JsonArray>();
+    for (JsonObject jStep : jProg)
+    {
+        SubStrip::TeAnimation eAnim = SubStrip::eGetAnimByName(jStep["ANIM"].as<const char*>()); // missing: NB_ANIMS
+        uint16_t u16Duration = jStep["DURATION"] | 0;
+        if (u8AppLed_PlaylistLen >= LED_PLAYLIST_MAX)
+        { break; }
+        if ((eAnim >= SubStrip::NB_ANIMS) || !u16Duration)
+        { continue; }
+        tAppLed_Playlist[u8AppLed_PlaylistLen].u8Anim = eAnim;
+        tAppLed_Playlist[u8AppLed_PlaylistLen].u16DurationS = u16Duration;
+        tAppLed_Playlist[u8AppLed_PlaylistLen].u16XfadeMs = jStep["XFADE"] | LED_XFADE_MS;
+        u8AppLed_PlaylistLen++;
+    }
+    bAppCfg_UnlockJson();
+    snprintf(tcPrint, PRINT_UTILS_MAX_BUF, "[AppLED_init] playlist: %u step(s)\r\n", u8AppLed_PlaylistLen);
+    APP_TRACE(tcPrint);
+    return u8AppLed_PlaylistLen;
+}
+
+/*******************************************************************************
+ * @brief Post one playlist step to all strips, as a substrip command does
+ * @details The step crossfade goes with its animation only: the crossfade
+ *          set by eAppLed_SetCrossfade() stays for the other changes.
+ * @param u8Step playlist index
+ ******************************************************************************/
+static void vAppLed_PostStep(uint8_t u8Step)
+{
+    char tcDbgString[PRINT_UTILS_MAX_BUF] = {0};
+    const TstAppLed_PlayStep *pstStep = &tAppLed_Playlist[u8Step];
+    TstAppLed_Batch stBatch;
+    vAppLed_BatchInit(&stBatch);
+    stBatch.stValues.eAnimation = (SubStrip::TeAnimation)pstStep->u8Anim;
+    stBatch.stValues.u16StepXfadeMs = pstStep->u16XfadeMs;
+    stBatch.u32Mask = _LED_PARAM_BIT(_LED_PARAM_ANIM) | _LED_PARAM_BIT(_LED_PARAM_STEP_XFADE);
+    eApp_RetVal eRet = eAppLed_BatchCommit(&stBatch, _LED_ALLSTRIPS);
+    snprintf(tcDbgString, PRINT_UTILS_MAX_BUF, "[APP_ANIM] [%u] step %u: %s, %u s ->(%d)\r\n",
+        millis(), u8Step, SubStrip::pcGetAnimName((SubStrip::TeAnimation)pstStep->u8Anim), pstStep->u16DurationS, eRet);
+    APP_TRACE(tcDbgString);
+}
+
+/*******************************************************************************
+ * @brief AppLeds playlist task
+ * @details Created for two steps or more only, never deleted: the schedule
+ *          task suspends and resumes it through xAppLed_AnimTask. Posts each
+ *          step and sleeps for its duration. The render crossfades to the
+ *          new animation from the preallocated transition buffers.
+ ******************************************************************************/
+void vAppLedsAnimTask(void *pvParam) {
+    (void)pvParam;
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    uint8_t u8Step = 0;
+    while (1) {
+        vAppLed_PostStep(u8Step);
+        TickType_t xDuration = pdMS_TO_TICKS((uint32_t)tAppLed_Playlist[u8Step].u16DurationS * 1000);
+        if ((TickType_t)(xTaskGetTickCount() - xLastWakeTime) > xDuration)
+        { xLastWakeTime = xTaskGetTickCount(); } // suspended by the scheduler: no catch-up
+        vTaskDelayUntil(&xLastWakeTime, xDuration);
+        u8Step = (u8Step + 1 < u8AppLed_PlaylistLen) ? (u8Step + 1) : 0;
+    }
+}
+
+/*******************************************************************************
+ * @brief Parse DEVICE_WORKING_TIMESLOT once into minute-of-day ranges
+ * @details [{"ON":"17:30:00","OFF":"22:00:00"}]: invalid ranges are skipped.
+ * @return number of ranges, 0: always on
+ ******************************************************************************/
+static uint8_t u8AppLed_LoadTimeslots(void)
+{
+    char tcPrint[PRINT_UTILS_MAX_BUF];
+    uint8_t u8Skipped = 0;
+    xAppLed_Timeslots.vClear();
+    bAppCfg_LockJson();
+    JsonArray jSlots = jAppCfg_Config["DEVICE_WORKING_TIMESLOT"].as<JsonArray>();
+    for (JsonObject jSlot : jSlots)
+    {
+        if (xAppLed_Timeslots.eAdd(jSlot["ON"].as<const char*>(), jSlot["OFF"].as<const char*>()) != Timeslot::RET_OK)
+        { u8Skipped++; }
+    }
+    bAppCfg_UnlockJson();
+    snprintf(tcPrint, PRINT_UTILS_MAX_BUF, "[AppLED_init] working timeslots: %u, %u skipped\r\n", xAppLed_Timeslots.u8GetNbSlots(), u8Skipped);
+    APP_TRACE(tcPrint);
+    return xAppLed_Timeslots.u8GetNbSlots();
+}
+
+/*******************************************************************************
+ * @brief Leave or enter the working timeslots
+ * @details Asleep, the render shows one black frame and blocks, the playlist
+ *          is suspended. On wake-up the render fades in and goes on where it
+ *          was, in the state the commands left it.
+ ******************************************************************************/
+static void vAppLed_Sleep(bool bSleep)
+{
+    bAppLed_Asleep = bSleep;
+    if (xAppLed_AnimTask != NULL)
+    {
+        if (bSleep)
+        { vTaskSuspend(xAppLed_AnimTask); }
+        else
+        { vTaskResume(xAppLed_AnimTask); }
+    }
+    vAppLed_Wake(); // out of its idle or blackout wait
+}
+
+/*******************************************************************************
+ * @brief AppLeds working timeslot task
+ * @details Sleeps until the next range edge, at most LED_SCHED_MAX_WAIT_S so
+ *          that a wall clock change (SNTP, DST) is caught. Until the wall
+ *          clock is set, the LEDs stay on.
+ ******************************************************************************/
+void vAppLedsScheduleTask(void *pvParam)
+{
+    (void)pvParam;
+    char tcDbgString[PRINT_UTILS_MAX_BUF] = {0};
+    while (1)
+    {
+        uint32_t u32WaitS = LED_SCHED_NO_CLOCK_S;
+        bool bOn = true;
+        time_t xNow = time(nullptr);
+        struct tm stNow;
+        localtime_r(&xNow, &stNow);
+        if (stNow.tm_year >= (LED_SCHED_MIN_YEAR - 1900))
+        {
+            uint16_t u16Minute = (stNow.tm_hour * 60) + stNow.tm_min;
+            bOn = xAppLed_Timeslots.bIsOn(u16Minute);
+            u32WaitS = ((uint32_t)xAppLed_Timeslots.u16MinutesToEdge(u16Minute) * 60) - stNow.tm_sec;
+            u32WaitS = (u32WaitS > LED_SCHED_MAX_WAIT_S) ? LED_SCHED_MAX_WAIT_S : u32WaitS;
+        }
+        if (bOn == bAppLed_Asleep)
+        {
+            snprintf(tcDbgString, PRINT_UTILS_MAX_BUF, "[APP_SCHED] %02u:%02u %s\r\n",
+                stNow.tm_hour, stNow.tm_min, bOn ? "wake up" : "sleep");
+            APP_TRACE(tcDbgString);
+            vAppLed_Sleep(!bOn);
+        }
+        vTaskDelay(pdMS_TO_TICKS(u32WaitS * 1000));
+    }
+}
+
+eApp_RetVal eAppLed_blackout(void) {
+    eAppLed_CurrentState = LEDSTRIP_BLACKOUT;
+    vAppLed_Wake(); // out of its idle wait
+    return eRet_Ok;
+}
+
+eApp_RetVal eAppLed_resume(void) {
+    eAppLed_CurrentState = LEDSTRIP_RUN;
+    vAppLed_Wake(); // out of its blackout wait
+    return eRet_Ok;
+}
+
+eApp_RetVal eAppLed_SetBrightness(uint8_t u8Value) {
+    stAppLed_Power.u8Brightness = u8Value; // power limited by the render, per frame
+    bAppLed_ForceShow = true; // applied by the output controller, even on a static frame
+    vAppLed_Wake();
+    return eRet_Ok;
+}
+
+/*******************************************************************************
+ * @brief Set the gamma of the output table, rebuilt by the render
+ * @param u16Gamma100 gamma x100, up to OUTPUT_LUT_GAMMA_MAX
+ ******************************************************************************/
+eApp_RetVal eAppLed_SetGamma(uint16_t u16Gamma100) {
+    eApp_RetVal eRet = eRet_Ok;
+    if (!u16Gamma100 || (u16Gamma100 > OUTPUT_LUT_GAMMA_MAX)) {
+        eRet = eRet_BadParameter;
+    }
+    else {
+        u16AppLed_Gamma100 = u16Gamma100;
+        u8AppLed_OutputRev++; // output table rebuilt by the render
+        bAppLed_ForceShow = true;
+        vAppLed_Wake();
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Set the white balance of the output table, rebuilt by the render
+ * @param xBalance scale of each channel, black is refused
+ ******************************************************************************/
+eApp_RetVal eAppLed_SetWhiteBalance(CRGB xBalance) {
+    eApp_RetVal eRet = eRet_Ok;
+    if (!xBalance) {
+        eRet = eRet_BadParameter;
+    }
+    else {
+        u32AppLed_Balance = ((uint32_t)xBalance.r << 16) | ((uint32_t)xBalance.g << 8) | xBalance.b;
+        u8AppLed_OutputRev++;
+        bAppLed_ForceShow = true;
+        vAppLed_Wake();
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Set the current budget of the LEDs, brightness is scaled down on the
+ *        frames that would exceed it
+ * @param u32BudgetMa supply current for the LEDs, 0 for no limit
+ ******************************************************************************/
+eApp_RetVal eAppLed_SetPowerBudget(uint32_t u32BudgetMa) {
+    stAppLed_Power.u32BudgetMa = u32BudgetMa;
+    bAppLed_ForceShow = true;
+    vAppLed_Wake();
+    return eRet_Ok;
+}
+
+eApp_RetVal eAppLed_GetPowerCounters(TstAppLed_PowerCounters *pstCounters) {
+    eApp_RetVal eRet = eRet_Ok;
+    if (pstCounters == nullptr) {
+        eRet = eRet_BadParameter;
+    }
+    else {
+        *pstCounters = stAppLed_Power;
+    }
+    return eRet;
+}
+
+eApp_RetVal eAppLed_SetKeepAlive(uint16_t u16PeriodMs) {
+    u16AppLed_KeepAliveMs = u16PeriodMs;
+    vAppLed_Wake(); // an idle wait may be longer than the new period
+    return eRet_Ok;
+}
+
+eApp_RetVal eAppLed_GetFrameCounters(TstAppLed_FrameCounters *pstCounters) {
+    eApp_RetVal eRet = eRet_Ok;
+    if (pstCounters == nullptr) {
+        eRet = eRet_BadParameter;
+    }
+    else {
+        *pstCounters = stAppLed_Counters;
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Read the render CPU time spent in a state since boot
+ * @param eState state
+ * @param pstCounters copy of the counters
+ ******************************************************************************/
+eApp_RetVal eAppLed_GetCpuCounters(TeAppLed_CpuState eState, TstAppLed_CpuCounters *pstCounters) {
+    eApp_RetVal eRet = eRet_Ok;
+    if ((pstCounters == nullptr) || (eState >= eLedCpu_NbStates)) {
+        eRet = eRet_BadParameter;
+    }
+    else {
+        portENTER_CRITICAL(&xAppLed_CpuMux);
+        *pstCounters = tAppLed_Cpu[eState];
+        portEXIT_CRITICAL(&xAppLed_CpuMux);
+    }
+    return eRet;
+}
+
+const char *pcAppLed_GetCpuStateName(TeAppLed_CpuState eState) {
+    return (eState < eLedCpu_NbStates) ? CtcAppLed_CpuStates[eState] : "?";
+}
+
+#if APP_REALTIME
+eApp_RetVal eAppLed_GetRealtimeCounters(Realtime::TstCounters *pstCounters) {
+    eApp_RetVal eRet = eRet_Ok;
+    if (pstCounters == nullptr) {
+        eRet = eRet_BadParameter;
+    }
+    else {
+        *pstCounters = xAppLed_Realtime.stGetCounters();
+    }
+    return eRet;
+}
+#endif
+
+eApp_RetVal eAppLed_SetAnimation(SubStrip::TeAnimation eAnimation, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.eAnimation = eAnimation;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_ANIM), &stParams);
+}
+
+eApp_RetVal eAppLed_SetSpeed(uint8_t u8Speed, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.u8Speed = u8Speed;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_SPEED), &stParams);
+}
+
+eApp_RetVal eAppLed_SetPeriod(uint32_t u32Period, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.u32Period = u32Period;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_PERIOD), &stParams);
+}
+
+eApp_RetVal eAppLed_SetFade(uint16_t u16FadeMs, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.u16MsFade = u16FadeMs;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_FADE), &stParams);
+}
+
+eApp_RetVal eAppLed_SetDirection(SubStrip::TeDirection eDirection, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.eDirection = eDirection;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_DIR), &stParams);
+}
+
+eApp_RetVal eAppLed_SetOffset(uint16_t u16Offset, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.u16Offset = u16Offset;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_OFFSET), &stParams);
+}
+
+eApp_RetVal eAppLed_SetBpm(uint8_t u8Bpm, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.u8Bpm = u8Bpm;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_BPM), &stParams);
+}
+
+eApp_RetVal eAppLed_SetFps(uint8_t u8Fps, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.u8Fps = u8Fps;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_FPS), &stParams);
+}
+
+eApp_RetVal eAppLed_SetWidth(uint8_t u8Width, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.u8Width = u8Width;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_WIDTH), &stParams);
+}
+
+eApp_RetVal eAppLed_SetSeed(uint32_t u32Seed, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.u32Seed = u32Seed;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_SEED), &stParams);
+}
+
+/*******************************************************************************
+ * @brief Set the crossfade of the animation changes of a strip
+ * @details A setting of the strip, not of one change: it applies to every
+ *          later animation change until set again. Playlist steps post
+ *          their own with their animation, this one is kept.
+ * @param u16XfadeMs crossfade duration, 0: cut
+ * @param u8Index strip index or _LED_ALLSTRIPS
+ ******************************************************************************/
+eApp_RetVal eAppLed_SetCrossfade(uint16_t u16XfadeMs, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    stParams.u16XfadeMs = u16XfadeMs;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_XFADE), &stParams);
+}
+
+eApp_RetVal eAppLed_SetLayer(uint8_t u8Layer, SubStrip::TeAnimation eAnimation, SubStrip::TeBlend eBlend, uint8_t u8Alpha, uint8_t u8Index) {
+    TstAppLed_Params stParams;
+    if (!u8Layer || (u8Layer > u8AppLed_NbLayers)) {
+        return eRet_BadParameter; // beyond DEVICE_LAYERS: no pool
+    }
+    stParams.tLayers[u8Layer - 1].eAnimation = eAnimation;
+    stParams.tLayers[u8Layer - 1].eBlend = eBlend;
+    stParams.tLayers[u8Layer - 1].u8Alpha = u8Alpha;
+    return eAppLed_PostParams(u8Index, _LED_PARAM_BIT(_LED_PARAM_LAYER + u8Layer - 1), &stParams);
+}
+
+eApp_RetVal eAppLed_SetPalette(uint8_t u8PaletteIndex, uint8_t u8SubStripIndex) {
+    TstAppLed_Params stParams;
+    stParams.u8Palette = u8PaletteIndex;
+    return eAppLed_PostParams(u8SubStripIndex, _LED_PARAM_BIT(_LED_PARAM_PALETTE), &stParams);
+}
+
+/*******************************************************************************
+ * @brief Replace a color of a custom palette, or append one
+ * @details Black is refused, as it used to end a palette.
+ * @param xColor new color, not black
+ * @param u8PaletteIndex custom palette
+ * @param u8Index color index, at most the number of colors
+ ******************************************************************************/
+eApp_RetVal eAppLed_LoadColorAt(CRGB xColor, uint8_t u8PaletteIndex, uint8_t u8Index) {
+    eApp_RetVal eRet = eRet_Ok;
+    if ((u8Index >= LED_STATIC_PALETTE_NB) || (u8PaletteIndex >= LED_PALETTE_NB) || (xColor == CRGB::Black))
+    { eRet = eRet_BadParameter; }
+    else if ((xAppLed_PaletteMutex == nullptr) || !xSemaphoreTake(xAppLed_PaletteMutex, portMAX_DELAY))
+    { eRet = eRet_InternalError; }
+    else {
+        // the lookup table is rebuilt in the writers' buffer, the write
+        // section only takes the result
+        portENTER_CRITICAL(&xAppLed_ParamMux);
+        xAppLed_PaletteEdit = tStagedPalettes[u8PaletteIndex];
+        portEXIT_CRITICAL(&xAppLed_ParamMux);
+        if (xAppLed_PaletteEdit.eSetColor(u8Index, xColor) < Palette::RET_OK)
+        { eRet = eRet_BadParameter; }
+        else
+        { vAppLed_StagePalette(u8PaletteIndex, &xAppLed_PaletteEdit); }
+        xSemaphoreGive(xAppLed_PaletteMutex);
+    }
+    return eRet;
 }
 
 eApp_RetVal eAppLed_LoadColors(CRGB *xColor, uint8_t u8NbColors, uint8_t u8PaletteIndex) {
     eApp_RetVal eRet = eRet_Ok;
-    if ((u8NbColors > LED_STATIC_PALETTE_NB) || (u8NbColors == 0) || (u8PaletteIndex >= stAppLED_Config.u8NbStrips))
+    if ((u8NbColors > LED_STATIC_PALETTE_NB) || (u8NbColors == 0) || (u8PaletteIndex >= LED_PALETTE_NB))
+    { eRet = eRet_BadParameter; }
+    else if ((xAppLed_PaletteMutex == nullptr) || !xSemaphoreTake(xAppLed_PaletteMutex, portMAX_DELAY))
+    { eRet = eRet_InternalError; }
+    else {
+        // copied first to go on from its revision
+        portENTER_CRITICAL(&xAppLed_ParamMux);
+        xAppLed_PaletteEdit = tStagedPalettes[u8PaletteIndex];
+        portEXIT_CRITICAL(&xAppLed_ParamMux);
+        if (xAppLed_PaletteEdit.eLoad(xColor, u8NbColors) < Palette::RET_OK)
+        { eRet = eRet_BadParameter; }
+        else
+        { vAppLed_StagePalette(u8PaletteIndex, &xAppLed_PaletteEdit); }
+        xSemaphoreGive(xAppLed_PaletteMutex);
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Post an edited palette, built by the writer
+ * @details Palette writers hold xAppLed_PaletteMutex from the copy of the
+ *          staged palette to its post: no edit is lost to another writer.
+ * @param u8PaletteIndex staged palette
+ * @param pxPalette edited palette
+ ******************************************************************************/
+static void vAppLed_StagePalette(uint8_t u8PaletteIndex, const Palette *pxPalette)
+{
+    uint32_t u32Stamp = u32AppLed_WriteBegin();
+    tStagedPalettes[u8PaletteIndex] = *pxPalette;
+    tu32AppLed_PaletteStamps[u8PaletteIndex] = u32Stamp;
+    vAppLed_WriteEnd(u32Stamp);
+}
+
+/*******************************************************************************
+ * @brief Check parameters before they are posted, the render applies them
+ *        later and cannot report an error
+ * @param u8Index strip index or _LED_ALLSTRIPS
+ * @param u32Mask _LED_PARAM_BIT() of the fields to check
+ * @param pstValues values
+ ******************************************************************************/
+static eApp_RetVal eAppLed_CheckParams(uint8_t u8Index, uint32_t u32Mask, const TstAppLed_Params *pstValues)
+{
+    eApp_RetVal eRet = eRet_Ok;
+    uint16_t u16MinLeds = SUBSTRIP_MAX_LEDS;
+    if ((u8Index >= stAppLED_Config.u8NbStrips) && (u8Index != _LED_ALLSTRIPS))
+    { return eRet_BadParameter; }
+    uint8_t u8First = (u8Index == _LED_ALLSTRIPS) ? 0 : u8Index;
+    uint8_t u8Last = (u8Index == _LED_ALLSTRIPS) ? stAppLED_Config.u8NbStrips : (u8Index + 1);
+    for (uint8_t i = u8First; i < u8Last; i++) {
+        u16MinLeds = (stAppLED_Config.pu16Strips[i] < u16MinLeds) ? stAppLED_Config.pu16Strips[i] : u16MinLeds;
+    }
+
+    if (pstAppLed_Params == nullptr)
+    { eRet = eRet_InternalError; }
+    else if ((u32Mask & _LED_PARAM_BIT(_LED_PARAM_ANIM)) && (pstValues->eAnimation >= SubStrip::NB_ANIMS))
+    { eRet = eRet_BadParameter; }
+    else if ((u32Mask & _LED_PARAM_BIT(_LED_PARAM_PALETTE)) &&
+        ((pstValues->u8Palette >= LED_PALETTE_NB) || !tStagedPalettes[pstValues->u8Palette].u8GetNbColors()))
+    { eRet = eRet_BadParameter; }
+    else if ((u32Mask & _LED_PARAM_BIT(_LED_PARAM_FADE)) && !pstValues->u16MsFade)
+    { eRet = eRet_BadParameter; }
+    else if ((u32Mask & _LED_PARAM_BIT(_LED_PARAM_DIR)) && (pstValues->eDirection > SubStrip::REVERSE_OUTIN))
+    { eRet = eRet_BadParameter; }
+    else if ((u32Mask & _LED_PARAM_BIT(_LED_PARAM_OFFSET)) && (pstValues->u16Offset > u16MinLeds))
+    { eRet = eRet_BadParameter; }
+    else if ((u32Mask & _LED_PARAM_BIT(_LED_PARAM_BPM)) && !pstValues->u8Bpm)
+    { eRet = eRet_BadParameter; }
+    else if ((u32Mask & _LED_PARAM_BIT(_LED_PARAM_FPS)) && (!pstValues->u8Fps || (pstValues->u8Fps > SUBSTRIP_MAX_FPS)))
+    { eRet = eRet_BadParameter; }
+    else if ((u32Mask & _LED_PARAM_BIT(_LED_PARAM_WIDTH)) && ((pstValues->u8Width < 2) || (pstValues->u8Width > SUBSTRIP_MAX_WIDTH)))
     { eRet = eRet_BadParameter; }
     else {
-        if (LOCK_LEDS()) {
-            memset(tCustomPalettes[u8PaletteIndex], 0, sizeof(CRGB) * (LED_STATIC_PALETTE_NB + 1));
-            memcpy(tCustomPalettes[u8PaletteIndex], xColor, sizeof(CRGB) * u8NbColors);
-            UNLOCK_LEDS();
+        for (uint8_t k = 0; k < (SUBSTRIP_MAX_LAYERS - 1); k++) {
+            if ((u32Mask & _LED_PARAM_BIT(_LED_PARAM_LAYER + k)) &&
+                ((pstValues->tLayers[k].eAnimation >= SubStrip::NB_ANIMS) || (pstValues->tLayers[k].eBlend >= SubStrip::NB_BLENDS)))
+            { eRet = eRet_BadParameter; }
         }
     }
     return eRet;
 }
 
+/*******************************************************************************
+ * @brief Post parameters of one or all strips, applied by the render task at
+ *        the start of its next frame. Never waits for the render.
+ * @param u8Index strip index or _LED_ALLSTRIPS
+ * @param u32Mask _LED_PARAM_BIT() of the fields to post
+ * @param pstValues values, only the fields in u32Mask are read
+ ******************************************************************************/
+static eApp_RetVal eAppLed_PostParams(uint8_t u8Index, uint32_t u32Mask, const TstAppLed_Params *pstValues)
+{
+    eApp_RetVal eRet = eAppLed_CheckParams(u8Index, u32Mask, pstValues);
+    if (eRet >= eRet_Ok) {
+        uint8_t u8First = (u8Index == _LED_ALLSTRIPS) ? 0 : u8Index;
+        uint8_t u8Last = (u8Index == _LED_ALLSTRIPS) ? stAppLED_Config.u8NbStrips : (u8Index + 1);
+        uint32_t u32Stamp = u32AppLed_WriteBegin();
+        for (uint8_t i = u8First; i < u8Last; i++) {
+            TstAppLed_Params *pstDst = &pstAppLed_Params[i];
+            for (uint8_t u8Param = 0; u8Param < _LED_NB_PARAMS; u8Param++) {
+                if (u32Mask & _LED_PARAM_BIT(u8Param)) {
+                    vAppLed_CopyParam(pstDst, pstValues, u8Param);
+                    pstDst->tu32Stamp[u8Param] = u32Stamp;
+                }
+            }
+        }
+        vAppLed_WriteEnd(u32Stamp);
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Open a write section of the parameter seqlock
+ * @details Writers are serialized by a spinlock held for a few copies only,
+ *          the render never takes it.
+ * @return stamp of the write, the even sequence it will be published with
+ ******************************************************************************/
+static uint32_t u32AppLed_WriteBegin(void)
+{
+    portENTER_CRITICAL(&xAppLed_ParamMux);
+    uint32_t u32Seq = u32AppLed_ParamSeq + 1; // odd: write in progress
+    __atomic_store_n(&u32AppLed_ParamSeq, u32Seq, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return u32Seq + 1;
+}
+
+/*******************************************************************************
+ * @brief Close a write section, publish the parameters
+ * @param u32Stamp value returned by u32AppLed_WriteBegin()
+ ******************************************************************************/
+static void vAppLed_WriteEnd(uint32_t u32Stamp)
+{
+    __atomic_store_n(&u32AppLed_ParamSeq, u32Stamp, __ATOMIC_RELEASE);
+    portEXIT_CRITICAL(&xAppLed_ParamMux);
+    vAppLed_Wake(); // an idle render would not latch before its timeout
+}
+
+/*******************************************************************************
+ * @brief Copy one parameter field
+ ******************************************************************************/
+static void vAppLed_CopyParam(TstAppLed_Params *pstDst, const TstAppLed_Params *pstSrc, uint8_t u8Param)
+{
+    switch (u8Param)
+    {
+        case _LED_PARAM_ANIM:       pstDst->eAnimation = pstSrc->eAnimation; break;
+        case _LED_PARAM_PALETTE:    pstDst->u8Palette = pstSrc->u8Palette; break;
+        case _LED_PARAM_SPEED:      pstDst->u8Speed = pstSrc->u8Speed; break;
+        case _LED_PARAM_PERIOD:     pstDst->u32Period = pstSrc->u32Period; break;
+        case _LED_PARAM_FADE:       pstDst->u16MsFade = pstSrc->u16MsFade; break;
+        case _LED_PARAM_DIR:        pstDst->eDirection = pstSrc->eDirection; break;
+        case _LED_PARAM_OFFSET:     pstDst->u16Offset = pstSrc->u16Offset; break;
+        case _LED_PARAM_BPM:        pstDst->u8Bpm = pstSrc->u8Bpm; break;
+        case _LED_PARAM_FPS:        pstDst->u8Fps = pstSrc->u8Fps; break;
+        case _LED_PARAM_WIDTH:      pstDst->u8Width = pstSrc->u8Width; break;
+        case _LED_PARAM_SEED:       pstDst->u32Seed = pstSrc->u32Seed; break;
+        case _LED_PARAM_XFADE:      pstDst->u16XfadeMs = pstSrc->u16XfadeMs; break;
+        case _LED_PARAM_STEP_XFADE: pstDst->u16StepXfadeMs = pstSrc->u16StepXfadeMs; break;
+        default:
+        pstDst->tLayers[u8Param - _LED_PARAM_LAYER] = pstSrc->tLayers[u8Param - _LED_PARAM_LAYER];
+        break;
+    }
+}
+
+/*******************************************************************************
+ * @brief Apply one latched parameter field to a strip, render task only
+ ******************************************************************************/
+static void vAppLed_ApplyParam(SubStrip *pObj, const TstAppLed_Params *pstParams, uint8_t u8Param)
+{
+    switch (u8Param)
+    {
+        case _LED_PARAM_ANIM:
+        {
+            // a step crossfade is posted in the same write as its animation
+            bool bStep = (pstParams->tu32Stamp[_LED_PARAM_STEP_XFADE] == pstParams->tu32Stamp[_LED_PARAM_ANIM]);
+            pObj->eCrossfade(pstParams->eAnimation, bStep ? pstParams->u16StepXfadeMs : pstParams->u16XfadeMs);
+        }
+        break;
+        case _LED_PARAM_PALETTE:    pObj->eSetColorPalette(&tCustomPalettes[pstParams->u8Palette]); break;
+        case _LED_PARAM_SPEED:      pObj->eSetSpeed(pstParams->u8Speed); break;
+        case _LED_PARAM_PERIOD:     pObj->eSetPeriod(pstParams->u32Period); break;
+        case _LED_PARAM_FADE:       pObj->eSetFadeRate(pstParams->u16MsFade); break;
+        case _LED_PARAM_DIR:        pObj->eSetDirection(pstParams->eDirection); break;
+        case _LED_PARAM_OFFSET:     pObj->eSetOffset(pstParams->u16Offset); break;
+        case _LED_PARAM_BPM:        pObj->eSetBpm(pstParams->u8Bpm); break;
+        case _LED_PARAM_FPS:        pObj->eSetFps(pstParams->u8Fps); break;
+        case _LED_PARAM_WIDTH:      pObj->eSetWidth(pstParams->u8Width); break;
+        case _LED_PARAM_SEED:       pObj->eSetSeed(pstParams->u32Seed); break;
+        case _LED_PARAM_XFADE:      break;
+        case _LED_PARAM_STEP_XFADE: break;
+        default:
+        {
+            const TstAppLed_LayerParams *pstLayer = &pstParams->tLayers[u8Param - _LED_PARAM_LAYER];
+            pObj->eSetLayer(u8Param - _LED_PARAM_LAYER + 1, pstLayer->eAnimation, pstLayer->eBlend, pstLayer->u8Alpha);
+        }
+        break;
+    }
+}
+
+/*******************************************************************************
+ * @brief Latch the posted parameters, once per frame at the start of render
+ * @details Seqlock read: the table is copied without lock, then kept only if
+ *          no writer ran meanwhile. Otherwise nothing is applied and the latch
+ *          is tried again on the next frame: the render never waits.
+ *          Changed palettes and the parameters are copied first, checked
+ *          once, then committed together: a frame never shows a new palette
+ *          with the old parameters. Palettes come first, strips may then
+ *          select them.
+ ******************************************************************************/
+static void vAppLed_LatchParams(void)
+{
+    uint32_t u32Seq = __atomic_load_n(&u32AppLed_ParamSeq, __ATOMIC_ACQUIRE);
+    uint32_t u32Palettes = 0;
+    if ((u32Seq == u32AppLed_LatchedSeq) || (u32Seq & 1))
+    { return; } // nothing new, or a writer is active
+
+    for (uint8_t p = 0; p < LED_PALETTE_NB; p++) {
+        if ((int32_t)(tu32AppLed_PaletteStamps[p] - u32AppLed_LatchedSeq) > 0) {
+            tAppLed_LatchPalettes[p] = tStagedPalettes[p];
+            u32Palettes |= (uint32_t)1 << p;
+        }
+    }
+    memcpy(pstAppLed_Latched, pstAppLed_Params, stAppLED_Config.u8NbStrips * sizeof(TstAppLed_Params));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&u32AppLed_ParamSeq, __ATOMIC_RELAXED) != u32Seq)
+    { return; }
+
+    for (uint8_t p = 0; p < LED_PALETTE_NB; p++) {
+        // strips holding this palette re-initialize from its revision
+        if (u32Palettes & ((uint32_t)1 << p))
+        { tCustomPalettes[p] = tAppLed_LatchPalettes[p]; }
+    }
+    SubStrip *pObj = SubStrips;
+    for (uint8_t i = 0; i < stAppLED_Config.u8NbStrips; i++) {
+        for (uint8_t u8Param = 0; u8Param < _LED_NB_PARAMS; u8Param++) {
+            if ((int32_t)(pstAppLed_Latched[i].tu32Stamp[u8Param] - u32AppLed_LatchedSeq) > 0)
+            { vAppLed_ApplyParam(pObj, &pstAppLed_Latched[i], u8Param); }
+        }
+        pObj++;
+    }
+    u32AppLed_LatchedSeq = u32Seq;
+}
+
+/*******************************************************************************
+ * @brief Configure one parameter of one or all strips
+ * @param u8StripId strip index or _LED_ALLSTRIPS
+ * @param u8CmdIndex eArgSubstrip
+ * @param pcValue value, as given on the CLI
+ ******************************************************************************/
 eApp_RetVal eAppLed_ConfigSubstrip(uint8_t u8StripId, uint8_t u8CmdIndex, const char* pcValue)
 {
-    eApp_RetVal eRet;
+    TstAppLed_Batch stBatch;
+    vAppLed_BatchInit(&stBatch);
+    eApp_RetVal eRet = eAppLed_BatchAdd(&stBatch, u8CmdIndex, pcValue);
+    if (eRet >= eRet_Ok)
+    { eRet = eAppLed_BatchCommit(&stBatch, u8StripId); }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Start an empty batch of parameter changes
+ ******************************************************************************/
+void vAppLed_BatchInit(TstAppLed_Batch *pstBatch)
+{
+    memset(pstBatch, 0, sizeof(TstAppLed_Batch));
+}
+
+/*******************************************************************************
+ * @brief Add one parameter to a batch, nothing is applied before the commit
+ * @param pstBatch batch
+ * @param u8CmdIndex eArgSubstrip
+ * @param pcValue value, as given on the CLI
+ ******************************************************************************/
+eApp_RetVal eAppLed_BatchAdd(TstAppLed_Batch *pstBatch, uint8_t u8CmdIndex, const char* pcValue)
+{
+    eApp_RetVal eRet = eRet_Ok;
+    TstAppLed_Params *pstValues = &pstBatch->stValues;
     uint16_t u16value = atoi(pcValue);
     switch(u8CmdIndex)
     {
         case eArg_palette:
-        eRet = eAppLed_SetPalette(u16value, u8StripId);
+        pstValues->u8Palette = u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_PALETTE);
         break;
 
         case eArg_anim:
-        eRet = eAppLed_SetAnimation((SubStrip::TeAnimation)u8StrList2Index(pcValue, (const char**)tpcAppLED_Animations, ARRAY_SIZEOF(tpcAppLED_Animations)), u8StripId);
+        pstValues->eAnimation = SubStrip::eGetAnimByName(pcValue);
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_ANIM);
         break;
 
         case eArg_speed:
-        eRet = eAppLed_SetSpeed(u16value, u8StripId);
+        pstValues->u8Speed = u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_SPEED);
         break;
 
         case eArg_period:
-        eRet = eAppLed_SetPeriod(u16value, u8StripId);
+        pstValues->u32Period = u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_PERIOD);
         break;
 
         case eArg_fade:
-        eRet = eAppLed_SetFade(u16value, u8StripId);
+        pstValues->u16MsFade = u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_FADE);
         break;
 
         case eArg_dir:
-        eRet = eAppLed_SetDirection((SubStrip::TeDirection)u16value, u8StripId);
+        pstValues->eDirection = (SubStrip::TeDirection)u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_DIR);
         break;
 
         case eArg_offset:
-        eRet = eAppLed_SetOffset(u16value, u8StripId);
+        pstValues->u16Offset = u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_OFFSET);
         break;
 
         case eArg_bpm:
-        eRet = eAppLed_SetBpm(u16value, u8StripId);
+        pstValues->u8Bpm = u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_BPM);
+        break;
+
+        case eArg_fps:
+        pstValues->u8Fps = u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_FPS);
+        break;
+
+        case eArg_width:
+        pstValues->u8Width = u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_WIDTH);
+        break;
+
+        case eArg_seed:
+        pstValues->u32Seed = strtoul(pcValue, nullptr, 0);
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_SEED);
+        break;
+
+        case eArg_xfade:
+        pstValues->u16XfadeMs = u16value;
+        pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_XFADE);
+        break;
+
+        case eArg_layer:
+        {
+            // <layer>:<anim>[:<blend>[:<alpha>]], e.g. 1:glitter:add:255
+            char tcValue[32];
+            char *pcSave = nullptr;
+            strncpy(tcValue, pcValue, sizeof(tcValue) - 1);
+            tcValue[sizeof(tcValue) - 1] = '\0';
+            char *pcLayer = strtok_r(tcValue, ":", &pcSave);
+            char *pcAnim = strtok_r(nullptr, ":", &pcSave);
+            char *pcBlend = strtok_r(nullptr, ":", &pcSave);
+            char *pcAlpha = strtok_r(nullptr, ":", &pcSave);
+            uint8_t u8Layer = pcLayer ? atoi(pcLayer) : 0;
+            if ((pcAnim == nullptr) || !u8Layer || (u8Layer >= SUBSTRIP_MAX_LAYERS))
+            { eRet = eRet_BadParameter; }
+            else {
+                TstAppLed_LayerParams *pstLayer = &pstValues->tLayers[u8Layer - 1];
+                pstLayer->eAnimation = SubStrip::eGetAnimByName(pcAnim);
+                pstLayer->eBlend = pcBlend ? SubStrip::eGetBlendByName(pcBlend) : SubStrip::BLEND_ADD;
+                pstLayer->u8Alpha = pcAlpha ? atoi(pcAlpha) : 255;
+                pstBatch->u32Mask |= _LED_PARAM_BIT(_LED_PARAM_LAYER + u8Layer - 1);
+            }
+        }
+        break;
+
+        default:
+        eRet = eRet_BadParameter;
         break;
     }
     return eRet;
 }
 
-uint8_t u8StrList2Index(const char* pcToSearch, const char **pcStrList, uint8_t u8LstSize)
+/*******************************************************************************
+ * @brief Add the parameters of a JSON object to a batch
+ * @details Keys are the CLI argument names, values are strings or numbers:
+ *          {"anim":"wave","palette":1,"bpm":60,"layer":"1:glitter:add"}
+ *          Unknown keys are rejected.
+ ******************************************************************************/
+eApp_RetVal eAppLed_BatchAddJson(TstAppLed_Batch *pstBatch, JsonObjectConst jArgs)
 {
-    char **ptrLst = (char**)pcStrList;
-    uint8_t u8Ret = 0xFF;
-    for (uint8_t u8Cnt = 0; u8Cnt < u8LstSize; u8Cnt++)
+    eApp_RetVal eRet = eRet_Ok;
+    char tcValue[32];
+    for (JsonPairConst jPair : jArgs)
     {
-        if (strncmp(pcToSearch, *ptrLst, strlen(pcToSearch)) == 0)
+        uint8_t u8CmdIndex = 0;
+        if (!strcmp(jPair.key().c_str(), "id"))
+        { continue; } // strip selection, read by the caller
+        while ((u8CmdIndex < ARRAY_SIZEOF(CtcAppLed_argSubstrip)) && strcmp(jPair.key().c_str(), CtcAppLed_argSubstrip[u8CmdIndex]))
+        { u8CmdIndex++; }
+        if (u8CmdIndex >= ARRAY_SIZEOF(CtcAppLed_argSubstrip))
+        { eRet = eRet_BadParameter; }
+        else if (jPair.value().is<const char*>())
+        { eRet = eAppLed_BatchAdd(pstBatch, u8CmdIndex, jPair.value().as<const char*>()); }
+        else if (jPair.value().is<uint32_t>())
         {
-            u8Ret = u8Cnt;
-            break;
+            snprintf(tcValue, sizeof(tcValue), "%lu", (unsigned long)jPair.value().as<uint32_t>());
+            eRet = eAppLed_BatchAdd(pstBatch, u8CmdIndex, tcValue);
         }
-        ptrLst++;
+        else
+        { eRet = eRet_BadParameter; }
+        if (eRet < eRet_Ok)
+        { break; }
     }
-    return u8Ret;
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Configure one or all strips from a JSON object, MQTT side of the
+ *        substrip command: {"id":"all","anim":"wave","palette":1,"bpm":60}
+ * @details "id" is a strip index, or "all"; without "id", all strips. Any
+ *          other id is rejected, it never falls back to all strips.
+ ******************************************************************************/
+eApp_RetVal eAppLed_ConfigSubstripJson(JsonObjectConst jArgs)
+{
+    uint8_t u8StripId = _LED_ALLSTRIPS;
+    TstAppLed_Batch stBatch;
+    eApp_RetVal eRet = eRet_Ok;
+    JsonVariantConst jId = jArgs["id"];
+    if (jId.is<uint8_t>() && (jId.as<uint8_t>() != _LED_ALLSTRIPS))
+    { u8StripId = jId.as<uint8_t>(); }
+    else if (!jId.isNull() && !(jId.is<const char*>() && !strcmp(jId.as<const char*>(), "all")))
+    { eRet = eRet_BadParameter; }
+    if (eRet >= eRet_Ok) {
+        vAppLed_BatchInit(&stBatch);
+        eRet = eAppLed_BatchAddJson(&stBatch, jArgs);
+    }
+    if (eRet >= eRet_Ok)
+    { eRet = eAppLed_BatchCommit(&stBatch, u8StripId); }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Post a batch for one or all strips in a single seqlock write
+ * @details All values are checked first: the batch is applied entirely on the
+ *          next frame, or rejected as a whole.
+ ******************************************************************************/
+eApp_RetVal eAppLed_BatchCommit(const TstAppLed_Batch *pstBatch, uint8_t u8StripId)
+{
+    if (!pstBatch->u32Mask)
+    { return eRet_Ok; }
+    return eAppLed_PostParams(u8StripId, pstBatch->u32Mask, &pstBatch->stValues);
 }
 
 #endif // APP_FASTLED
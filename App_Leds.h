@@ -16,36 +16,172 @@
 #include <FastLED.h>
 #include "SubStrip.h"
 #include "App_Cli.h"
+#if APP_REALTIME
+#include "Realtime.h"
+#endif
 
 #define LED_SUBSTRIP_LEN    20
 #define LED_SUBSTRIP_NB     5
+#define LED_PALETTE_NB      LED_SUBSTRIP_NB // custom palettes, any strip may select one
 #define _LED_ALLSTRIPS      ((uint8_t)0xFF)
 
+/*
+ * Posted parameters of a strip: fields are written by eAppLed_Set* under the
+ * parameter seqlock, tu32Stamp[] records the sequence of each field's last
+ * write so the render applies only what changed since its previous latch.
+ */
+typedef enum {
+    _LED_PARAM_ANIM,
+    _LED_PARAM_PALETTE,
+    _LED_PARAM_SPEED,
+    _LED_PARAM_PERIOD,
+    _LED_PARAM_FADE,
+    _LED_PARAM_DIR,
+    _LED_PARAM_OFFSET,
+    _LED_PARAM_BPM,
+    _LED_PARAM_FPS,
+    _LED_PARAM_WIDTH,
+    _LED_PARAM_SEED,
+    _LED_PARAM_XFADE, // read by every animation change, nothing to apply alone
+    _LED_PARAM_STEP_XFADE, // read by the animation change posted with it only
+    _LED_PARAM_LAYER, // one per overlay layer
+    _LED_NB_PARAMS = _LED_PARAM_LAYER + SUBSTRIP_MAX_LAYERS - 1
+} TeAppLed_Param;
+
+#define _LED_PARAM_BIT(x)   ((uint32_t)1 << (x))
+
+typedef struct {
+    SubStrip::TeAnimation eAnimation;
+    SubStrip::TeBlend eBlend;
+    uint8_t u8Alpha;
+} TstAppLed_LayerParams;
+
+typedef struct {
+    SubStrip::TeAnimation eAnimation;
+    uint8_t u8Palette;
+    uint8_t u8Speed;
+    uint32_t u32Period;
+    uint16_t u16MsFade;
+    SubStrip::TeDirection eDirection;
+    uint16_t u16Offset;
+    uint8_t u8Bpm;
+    uint8_t u8Fps;
+    uint8_t u8Width;
+    uint32_t u32Seed;
+    uint16_t u16XfadeMs; // crossfade of every animation change until set again, 0: cut
+    uint16_t u16StepXfadeMs; // crossfade of this animation change, u16XfadeMs untouched
+    TstAppLed_LayerParams tLayers[SUBSTRIP_MAX_LAYERS - 1];
+    uint32_t tu32Stamp[_LED_NB_PARAMS];
+} TstAppLed_Params;
+
+/*
+ * Batch of parameter changes: filled by eAppLed_BatchAdd*(), posted at once by
+ * eAppLed_BatchCommit() so the render applies all of them on the same frame,
+ * or none of them if one value is out of range.
+ */
+typedef struct {
+    uint32_t u32Mask; // _LED_PARAM_BIT() of the fields set
+    TstAppLed_Params stValues;
+} TstAppLed_Batch;
+
+typedef struct {
+    uint32_t u32Shown;          // frames composed and transmitted
+    uint32_t u32KeepAlive;      // unchanged frames transmitted again
+    uint32_t u32Skipped;        // unchanged frames not transmitted
+    uint32_t u32Dropped;        // composed frames replaced before their transmit
+    uint32_t u32BusTimeSavedMs; // estimated wire time of skipped frames
+} TstAppLed_FrameCounters;
+
+typedef struct {
+    uint32_t u32BudgetMa;       // 0: no limit
+    uint32_t u32EstimatedMa;    // last frame, at the requested brightness
+    uint32_t u32DrawnMa;        // last frame, at the applied brightness
+    uint32_t u32PeakMa;         // highest u32DrawnMa
+    uint32_t u32LimitedFrames;  // frames shown with a reduced brightness
+    uint8_t u8Brightness;       // requested brightness
+    uint8_t u8Applied;          // brightness of the last frame
+} TstAppLed_PowerCounters;
+
+/*
+ * Render task CPU time, per state: busy is the time spent working, wall the
+ * time spent in the state, waits included. Idle is a RUN state whose frames
+ * stopped changing, asleep a blackout outside the working timeslots.
+ */
+#define FOREACH_LED_CPU_STATE(STATE)        \
+    STATE(eLedCpu_Run,      run)            \
+    STATE(eLedCpu_Idle,     idle)           \
+    STATE(eLedCpu_Blackout, blackout)       \
+    STATE(eLedCpu_Asleep,   asleep)         \
+    STATE(eLedCpu_Standby,  standby)        \
+    STATE(eLedCpu_Fixed,    fixed)
+
+#define GENERATE_LED_CPU_ENUM(ENUM, NAME)   ENUM,
+
+typedef enum {
+    FOREACH_LED_CPU_STATE(GENERATE_LED_CPU_ENUM)
+    eLedCpu_NbStates
+} TeAppLed_CpuState;
+
+typedef struct {
+    uint64_t u64BusyUs;         // rendering
+    uint64_t u64WallUs;         // rendering and waiting
+    uint32_t u32Wakes;          // task loop iterations
+} TstAppLed_CpuCounters;
+
 void AppLED_init(void);
 void AppLED_showLoop(void);
 
-#if APP_TASKS
-extern SemaphoreHandle_t    xLedStripSema;
-#define LOCK_LEDS()         xSemaphoreTake(xLedStripSema, portMAX_DELAY)
-#define UNLOCK_LEDS()       xSemaphoreGive(xLedStripSema)
-#endif
-
-extern const char *tpcAppLED_Animations[];
+/*
+ * Frame consistency: CLI/MQTT writers (eAppLed_Set*, eAppLed_LoadColor*)
+ * never touch SubStrip objects. They validate and post the new values into a
+ * per-strip parameter table guarded by a seqlock (a spinlock serializes the
+ * writers for a few copies only, palettes are built before). At the start of each frame the LED task
+ * copies the table without lock, keeps the copy if the sequence did not move
+ * and applies the changed fields; on a concurrent write it retries on the
+ * next frame. The render never blocks on a command and a frame always uses
+ * one consistent set of parameters. It then composes the frame into the back
+ * buffer and hands it over as the ready frame. The transmit task, on the
+ * other core, takes the ready frame and puts it on the wire while the next one
+ * renders. Three buffers rotate between the roles (front, ready, back), so the
+ * buffer on the wire is never written, a frame cannot tear and neither render
+ * nor commands wait for a transmit.
+ */
 
 eApp_RetVal eAppLed_blackout(void);
 eApp_RetVal eAppLed_resume(void);
 eApp_RetVal eAppLed_SetBrightness(uint8_t u8Value);
+eApp_RetVal eAppLed_SetKeepAlive(uint16_t u16PeriodMs);
+eApp_RetVal eAppLed_GetFrameCounters(TstAppLed_FrameCounters *pstCounters);
+eApp_RetVal eAppLed_SetGamma(uint16_t u16Gamma100);
+eApp_RetVal eAppLed_SetWhiteBalance(CRGB xBalance);
+eApp_RetVal eAppLed_SetPowerBudget(uint32_t u32BudgetMa);
+eApp_RetVal eAppLed_GetPowerCounters(TstAppLed_PowerCounters *pstCounters);
+eApp_RetVal eAppLed_GetCpuCounters(TeAppLed_CpuState eState, TstAppLed_CpuCounters *pstCounters);
+const char *pcAppLed_GetCpuStateName(TeAppLed_CpuState eState);
+#if APP_REALTIME
+eApp_RetVal eAppLed_GetRealtimeCounters(Realtime::TstCounters *pstCounters);
+#endif
 eApp_RetVal eAppLed_SetAnimation(SubStrip::TeAnimation eAnimation, uint8_t u8Index);
 eApp_RetVal eAppLed_SetSpeed(uint8_t u8Speed, uint8_t u8Index);
 eApp_RetVal eAppLed_SetPeriod(uint32_t u32Period, uint8_t u8Index);
 eApp_RetVal eAppLed_SetFade(uint16_t u16FadeMs, uint8_t u8Index);
 eApp_RetVal eAppLed_SetDirection(SubStrip::TeDirection eDirection, uint8_t u8Index);
-eApp_RetVal eAppLed_SetOffset(uint8_t u8Offset, uint8_t u8Index);
+eApp_RetVal eAppLed_SetOffset(uint16_t u16Offset, uint8_t u8Index);
 eApp_RetVal eAppLed_SetBpm(uint8_t u8Bpm, uint8_t u8Index);
+eApp_RetVal eAppLed_SetFps(uint8_t u8Fps, uint8_t u8Index);
+eApp_RetVal eAppLed_SetWidth(uint8_t u8Width, uint8_t u8Index);
+eApp_RetVal eAppLed_SetSeed(uint32_t u32Seed, uint8_t u8Index);
+eApp_RetVal eAppLed_SetCrossfade(uint16_t u16XfadeMs, uint8_t u8Index);
+eApp_RetVal eAppLed_SetLayer(uint8_t u8Layer, SubStrip::TeAnimation eAnimation, SubStrip::TeBlend eBlend, uint8_t u8Alpha, uint8_t u8Index);
 eApp_RetVal eAppLed_SetPalette(uint8_t u8PaletteIndex, uint8_t u8SubStripIndex);
 eApp_RetVal eAppLed_LoadColorAt(CRGB xColor, uint8_t u8PaletteIndex, uint8_t u8Index);
 eApp_RetVal eAppLed_LoadColors(CRGB *xColor, uint8_t u8NbColors, uint8_t u8PaletteIndex);
 eApp_RetVal eAppLed_ConfigSubstrip(uint8_t u8StripId, uint8_t u8CmdIndex, const char* pcValue);
+void vAppLed_BatchInit(TstAppLed_Batch *pstBatch);
+eApp_RetVal eAppLed_BatchAdd(TstAppLed_Batch *pstBatch, uint8_t u8CmdIndex, const char* pcValue);
+eApp_RetVal eAppLed_BatchAddJson(TstAppLed_Batch *pstBatch, JsonObjectConst jArgs);
+eApp_RetVal eAppLed_BatchCommit(const TstAppLed_Batch *pstBatch, uint8_t u8StripId);
+eApp_RetVal eAppLed_ConfigSubstripJson(JsonObjectConst jArgs);
 
 #endif // APP_FASTLED
 
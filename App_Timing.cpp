@@ -0,0 +1,216 @@
+/**
+ * @brief Render and transmit timing probes
+ * @file App_Timing.cpp
+ * @version 0.1
+ * @date 2025-12-18
+ * @author Nello
+ */
+
+#include "App_Timing.h"
+
+#if defined(APP_TIMING) && APP_TIMING
+
+/*******************************************************************************
+ *  TYPES
+ ******************************************************************************/
+/*
+ * Log-linear histogram of nanoseconds: values below 4 have their own bucket,
+ * above each power of two is split in 4. Bucket width is at most 25% of its
+ * value, up to 2^26 ns (67 ms); longer samples land in the last bucket.
+ */
+#define _TIMING_MAX_EXP         26
+#define _TIMING_NB_BUCKETS      (4 * (_TIMING_MAX_EXP - 1))
+#define _TIMING_CALIB_LOOPS     256
+
+typedef struct {
+    uint32_t u32Count;
+    uint32_t u32MinNs;
+    uint32_t u32MaxNs;
+    uint64_t u64SumNs;
+    uint32_t tu32Buckets[_TIMING_NB_BUCKETS];
+} TstAppTiming_Stats;
+
+#define GENERATE_TIMING_STR(ENUM, NAME)     #NAME,
+
+/*******************************************************************************
+ *  GLOBAL VARIABLES
+ ******************************************************************************/
+static TstAppTiming_Stats tstAppTiming_Stats[eTiming_NbProbes];
+static volatile uint32_t u32AppTiming_ResetReq; // one bit per probe, cleared by its writer
+static uint32_t u32AppTiming_Missed; // written by the render task only
+static uint32_t u32AppTiming_EmptyCycles;
+static uint32_t u32AppTiming_OverheadNs;
+static const char *CtcAppTiming_Names[] = {
+    FOREACH_TIMING_PROBE(GENERATE_TIMING_STR)
+};
+
+/*******************************************************************************
+ *  PROTOTYPES
+ ******************************************************************************/
+static uint8_t u8AppTiming_Bucket(uint32_t u32Ns);
+static uint32_t u32AppTiming_BucketTop(uint8_t u8Bucket);
+static void vAppTiming_Clear(TstAppTiming_Stats *pstStats);
+
+/*******************************************************************************
+ * @brief Clear the histograms, measure the probe cost
+ * @details The empty interval (two cycle counter reads) is taken off each
+ *          sample. The overhead is the cost of a whole probe, histogram update
+ *          included: what the render pays per probe.
+ ******************************************************************************/
+void vAppTiming_Init(void)
+{
+    uint32_t u32Min = UINT32_MAX;
+    for (uint16_t i = 0; i < _TIMING_CALIB_LOOPS; i++)
+    {
+        TIMING_START(u32Start);
+        uint32_t u32Cycles = ESP.getCycleCount() - u32Start;
+        u32Min = (u32Cycles < u32Min) ? u32Cycles : u32Min;
+    }
+    u32AppTiming_EmptyCycles = u32Min;
+
+    uint32_t u32Begin = ESP.getCycleCount();
+    for (uint16_t i = 0; i < _TIMING_CALIB_LOOPS; i++)
+    {
+        TIMING_START(u32Start);
+        TIMING_STOP(eTiming_Anim, u32Start);
+    }
+    uint32_t u32Total = ESP.getCycleCount() - u32Begin;
+    u32AppTiming_OverheadNs = (uint32_t)(((uint64_t)u32Total * 1000) / ((uint32_t)_TIMING_CALIB_LOOPS * getCpuFrequencyMhz()));
+
+    for (uint8_t p = 0; p < eTiming_NbProbes; p++)
+    { vAppTiming_Clear(&tstAppTiming_Stats[p]); }
+    u32AppTiming_Missed = 0;
+    u32AppTiming_ResetReq = 0;
+}
+
+/*******************************************************************************
+ * @brief Close a probe opened with TIMING_START(), same core only
+ ******************************************************************************/
+void vAppTiming_Stop(TeAppTiming_Probe eProbe, uint32_t u32StartCycles)
+{
+    uint32_t u32Cycles = ESP.getCycleCount() - u32StartCycles;
+    u32Cycles = (u32Cycles > u32AppTiming_EmptyCycles) ? (u32Cycles - u32AppTiming_EmptyCycles) : 0;
+    vAppTiming_Record(eProbe, (uint32_t)(((uint64_t)u32Cycles * 1000) / getCpuFrequencyMhz()));
+}
+
+/*******************************************************************************
+ * @brief Add a sample to a probe, from its writer task only
+ ******************************************************************************/
+void vAppTiming_Record(TeAppTiming_Probe eProbe, uint32_t u32Ns)
+{
+    TstAppTiming_Stats *pstStats = &tstAppTiming_Stats[eProbe];
+    if (u32AppTiming_ResetReq & (1UL << eProbe))
+    {
+        vAppTiming_Clear(pstStats);
+        if (eProbe == eTiming_Frame)
+        { u32AppTiming_Missed = 0; } // same writer
+        __atomic_fetch_and(&u32AppTiming_ResetReq, ~(1UL << eProbe), __ATOMIC_RELAXED);
+    }
+    pstStats->u32MinNs = (u32Ns < pstStats->u32MinNs) ? u32Ns : pstStats->u32MinNs;
+    pstStats->u32MaxNs = (u32Ns > pstStats->u32MaxNs) ? u32Ns : pstStats->u32MaxNs;
+    pstStats->u64SumNs += u32Ns;
+    pstStats->tu32Buckets[u8AppTiming_Bucket(u32Ns)]++;
+    pstStats->u32Count++;
+}
+
+/*******************************************************************************
+ * @brief Count a strip animated a whole frame period late, render task only
+ ******************************************************************************/
+void vAppTiming_CountMiss(void)
+{
+    u32AppTiming_Missed++;
+}
+
+/*******************************************************************************
+ * @brief Reset all probes and the missed frames counter
+ * @details Each writer clears its own probe on its next sample, so a reset
+ *          never races with a record.
+ ******************************************************************************/
+void vAppTiming_Reset(void)
+{
+    __atomic_fetch_or(&u32AppTiming_ResetReq, (1UL << eTiming_NbProbes) - 1, __ATOMIC_RELAXED);
+}
+
+/*******************************************************************************
+ * @brief Summary of a probe: min/avg/max and the 99th percentile
+ ******************************************************************************/
+eApp_RetVal eAppTiming_GetSummary(TeAppTiming_Probe eProbe, TstAppTiming_Summary *pstSummary)
+{
+    if ((eProbe >= eTiming_NbProbes) || (pstSummary == nullptr))
+    { return eRet_BadParameter; }
+
+    memset(pstSummary, 0, sizeof(TstAppTiming_Summary));
+    TstAppTiming_Stats *pstStats = &tstAppTiming_Stats[eProbe];
+    uint32_t u32Count = pstStats->u32Count;
+    if (!u32Count || (u32AppTiming_ResetReq & (1UL << eProbe)))
+    { return eRet_Ok; }
+
+    // read while the writer goes on: each field is consistent, the set within a few samples
+    pstSummary->u32Count = u32Count;
+    pstSummary->u32MinNs = pstStats->u32MinNs;
+    pstSummary->u32MaxNs = pstStats->u32MaxNs;
+    pstSummary->u32AvgNs = (uint32_t)(pstStats->u64SumNs / u32Count);
+    uint32_t u32Rank = u32Count - (u32Count / 100);
+    uint32_t u32Seen = 0;
+    for (uint8_t b = 0; b < _TIMING_NB_BUCKETS; b++)
+    {
+        u32Seen += pstStats->tu32Buckets[b];
+        if (u32Seen >= u32Rank)
+        {
+            pstSummary->u32P99Ns = u32AppTiming_BucketTop(b);
+            break;
+        }
+    }
+    pstSummary->u32P99Ns = (pstSummary->u32P99Ns > pstSummary->u32MaxNs) ? pstSummary->u32MaxNs : pstSummary->u32P99Ns;
+    return eRet_Ok;
+}
+
+uint32_t u32AppTiming_GetMissed(void)
+{
+    return (u32AppTiming_ResetReq & (1UL << eTiming_Frame)) ? 0 : u32AppTiming_Missed;
+}
+
+uint32_t u32AppTiming_GetOverheadNs(void)
+{
+    return u32AppTiming_OverheadNs;
+}
+
+const char *pcAppTiming_GetName(TeAppTiming_Probe eProbe)
+{
+    return (eProbe < eTiming_NbProbes) ? CtcAppTiming_Names[eProbe] : "?";
+}
+
+/*******************************************************************************
+ * @brief Histogram bucket of a sample: 4 buckets per power of two
+ ******************************************************************************/
+static uint8_t u8AppTiming_Bucket(uint32_t u32Ns)
+{
+    if (u32Ns < 4)
+    { return u32Ns; }
+    uint8_t u8Exp = 31 - __builtin_clz(u32Ns);
+    if (u8Exp >= _TIMING_MAX_EXP)
+    { return _TIMING_NB_BUCKETS - 1; }
+    return (4 * (u8Exp - 1)) + ((u32Ns >> (u8Exp - 2)) & 3);
+}
+
+/*******************************************************************************
+ * @brief Highest value of a bucket
+ ******************************************************************************/
+static uint32_t u32AppTiming_BucketTop(uint8_t u8Bucket)
+{
+    if (u8Bucket < 4)
+    { return u8Bucket; }
+    if (u8Bucket >= (_TIMING_NB_BUCKETS - 1))
+    { return UINT32_MAX; }
+    uint8_t u8Exp = (u8Bucket / 4) + 1;
+    uint32_t u32Low = (uint32_t)(4 + (u8Bucket & 3)) << (u8Exp - 2);
+    return u32Low + (1UL << (u8Exp - 2)) - 1;
+}
+
+static void vAppTiming_Clear(TstAppTiming_Stats *pstStats)
+{
+    memset(pstStats, 0, sizeof(TstAppTiming_Stats));
+    pstStats->u32MinNs = UINT32_MAX;
+}
+
+#endif // APP_TIMING
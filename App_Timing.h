@@ -0,0 +1,71 @@
+/**
+ * @brief Render and transmit timing probes
+ * @file App_Timing.h
+ * @version 0.1
+ * @date 2025-12-18
+ * @author Nello
+ */
+
+#ifndef _APP_TIMING_H
+#define _APP_TIMING_H
+
+#include "Config.h"
+
+#if defined(APP_TIMING) && APP_TIMING
+
+/*
+ * Timing probes, (enum, stats name). Each probe has a single writer task, so
+ * recording takes no lock:
+ *  - anim: one vManageAnimation() call (render task)
+ *  - compose: one eGetSubStrip() copy into the back buffer (render task)
+ *  - frame: a whole render pass, latch to publish (render task)
+ *  - show: one output driver show, wire time included (transmit task)
+ *  - jitter: render wake-up lateness against the requested wake-up
+ */
+#define FOREACH_TIMING_PROBE(PROBE)         \
+    PROBE(eTiming_Anim,     anim)           \
+    PROBE(eTiming_Compose,  compose)        \
+    PROBE(eTiming_Frame,    frame)          \
+    PROBE(eTiming_Show,     show)           \
+    PROBE(eTiming_Jitter,   jitter)
+
+#define GENERATE_TIMING_ENUM(ENUM, NAME)    ENUM,
+
+typedef enum {
+    FOREACH_TIMING_PROBE(GENERATE_TIMING_ENUM)
+    eTiming_NbProbes
+} TeAppTiming_Probe;
+
+typedef struct {
+    uint32_t u32Count;
+    uint32_t u32MinNs;
+    uint32_t u32AvgNs;
+    uint32_t u32MaxNs;
+    uint32_t u32P99Ns; // upper bound of the histogram bucket, within 25%
+} TstAppTiming_Summary;
+
+/*
+ * A probe reads the CPU cycle counter of its core: a few cycles, no call.
+ * The empty start/stop interval, measured by vAppTiming_Init(), is taken off
+ * each sample. The whole cost of a probe (both reads and the histogram update)
+ * is given by u32AppTiming_GetOverheadNs(), around 0.5 us at 240 MHz.
+ */
+#define TIMING_START(x)         uint32_t x = ESP.getCycleCount()
+#define TIMING_STOP(p, x)       vAppTiming_Stop(p, x)
+
+void vAppTiming_Init(void);
+void vAppTiming_Stop(TeAppTiming_Probe eProbe, uint32_t u32StartCycles);
+void vAppTiming_Record(TeAppTiming_Probe eProbe, uint32_t u32Ns);
+void vAppTiming_CountMiss(void);
+void vAppTiming_Reset(void);
+eApp_RetVal eAppTiming_GetSummary(TeAppTiming_Probe eProbe, TstAppTiming_Summary *pstSummary);
+uint32_t u32AppTiming_GetMissed(void);
+uint32_t u32AppTiming_GetOverheadNs(void);
+const char *pcAppTiming_GetName(TeAppTiming_Probe eProbe);
+
+#else
+#define TIMING_START(x)
+#define TIMING_STOP(p, x)
+#endif // APP_TIMING
+
+#endif // _APP_TIMING_H
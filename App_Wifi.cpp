@@ -10,6 +10,7 @@
  *  Includes
  ******************************************************************************/
 #include "App_Wifi.h"
+#include "App_Leds.h"
 #include "ESP32MQTTClient.h"
 #include "time.h"
 
@@ -167,6 +168,16 @@ void MqttCallback_Device(const std::string payload)
     char tcBuffer[256];
     snprintf(tcBuffer, 256, "[AppWifi] Mqtt rx from \"/lumiapp/%s\" -> %s\r\n", stAppWifi_Config.pcHostName, payload.c_str());
     APP_TRACE(tcBuffer);
+#if defined(APP_FASTLED) && APP_FASTLED
+    // {"substrip":{"id":0,"anim":"wave","palette":1,"bpm":60}}, applied on one frame
+    JsonDocument jDoc;
+    if (!deserializeJson(jDoc, payload.c_str()) && jDoc["substrip"].is<JsonObjectConst>())
+    {
+        eApp_RetVal eRet = eAppLed_ConfigSubstripJson(jDoc["substrip"].as<JsonObjectConst>());
+        snprintf(tcBuffer, 256, "[AppWifi] substrip ->(%d)\r\n", eRet);
+        APP_TRACE(tcBuffer);
+    }
+#endif
 }
 
 bool bAppWifi_SyncWifiConfig(void)
@@ -21,7 +21,7 @@
  *  Types, nums, macros
  ******************************************************************************/
 #define _MNG_RETURN(x)                      eRet = x
-#define CFG_NB_OBJ                          9
+#define CFG_NB_OBJ                          16
 
 typedef enum {
     TYPE_JSON_NULL,
@@ -49,7 +49,10 @@ const char CtcAppCfg_DefWifi[] = R"({"SSID":null,"PWD":null})";
 const char CtcAppCfg_DefMqtt[] = R"({"ADDR":null,"PORT":null,"LOGIN":null,"PWD":null,"GLOBAL_TOPIC":"/global","KEEPALIVE":60})";
 const char CtcAppCfg_DefPalettes[] = R"([{"NAME":"default","COLORS":["ffffff","ff0000"]}])";
 const char CtcAppCfg_DefProgArr[] = R"([{"ANIM":"glitter","DURATION":120}])";
+const char CtcAppCfg_DefOutputs[] = R"([{"PIN":4,"LEDS":0}])";
+const char CtcAppCfg_DefWhiteBalance[] = "FFB0F0";
 const char CtcAppCfg_DefWorkTimeSlot[] = R"([{"ON":"17:30:00","OFF":"22:00:00"},{"ON":"06:30:00","OFF":"08:00:00"}])";
+const char CtcAppCfg_DefRealtime[] = R"({"DDP_PORT":4048,"E131_PORT":5568,"UNIVERSE":1,"TIMEOUT":2500})";
 // const int32_t Cti32AppCfg_DefStripAssembly[5] = {20, 20, 20, 20, 20};
 
 const TstAppCfg_ParamObj tstAppCfg_Config[CFG_NB_OBJ] = {
@@ -93,6 +96,54 @@ const TstAppCfg_ParamObj tstAppCfg_Config[CFG_NB_OBJ] = {
         nullptr,
         0
     },
+    {
+        "DEVICE_OUTPUTS",
+        TYPE_JSON_ARRAY,
+        1,
+        TYPE_JSON_OBJECT,
+        CtcAppCfg_DefOutputs,
+        0
+    },
+    {
+        "DEVICE_POWER_MA",
+        TYPE_JSON_NUMBER,
+        0,
+        TYPE_JSON_NULL,
+        nullptr,
+        0
+    },
+    {
+        "DEVICE_LAYERS",
+        TYPE_JSON_NUMBER,
+        0,
+        TYPE_JSON_NULL,
+        nullptr,
+        0
+    },
+    {
+        "DEVICE_XFADE",
+        TYPE_JSON_NUMBER,
+        0,
+        TYPE_JSON_NULL,
+        nullptr,
+        1
+    },
+    {
+        "DEVICE_GAMMA",
+        TYPE_JSON_NUMBER,
+        0,
+        TYPE_JSON_NULL,
+        nullptr,
+        220
+    },
+    {
+        "DEVICE_WHITE_BALANCE",
+        TYPE_JSON_STRING,
+        0,
+        TYPE_JSON_NULL,
+        CtcAppCfg_DefWhiteBalance,
+        0
+    },
     {
         "DEVICE_PALETTES",
         TYPE_JSON_ARRAY,
@@ -117,6 +168,14 @@ const TstAppCfg_ParamObj tstAppCfg_Config[CFG_NB_OBJ] = {
         CtcAppCfg_DefWorkTimeSlot,
         0
     },
+    {
+        "DEVICE_REALTIME",
+        TYPE_JSON_OBJECT,
+        0,
+        TYPE_JSON_NULL,
+        CtcAppCfg_DefRealtime,
+        0
+    },
     {
         "DEVICE_LAST_CONTEXT",
         TYPE_JSON_OBJECT,
@@ -428,18 +487,18 @@ eApp_RetVal eAppCfg_SetStrips(const char* pcCfgFromCli)
 {
     eApp_RetVal eRet = eRet_Ok;
     char tcPrint[32];
-    uint8_t tu8StripAssembly[20] = {0};
-    uint8_t *pu8Tmp = tu8StripAssembly;
+    uint16_t tu16StripAssembly[20] = {0};
+    uint16_t *pu16Tmp = tu16StripAssembly;
     uint8_t u8cnt = 0;
     char *pcCfg = (char*) pcCfgFromCli;
     do
     {
-        *pu8Tmp = atoi(pcCfg);
+        *pu16Tmp = atoi(pcCfg);
         pcCfg = strchr(pcCfg, ',');
         pcCfg += (pcCfg != nullptr) ? 1 : 0;
-        if (*pu8Tmp != 0)
+        if (*pu16Tmp != 0)
         {
-            pu8Tmp++;
+            pu16Tmp++;
             u8cnt++;
         }
         else
@@ -448,12 +507,47 @@ eApp_RetVal eAppCfg_SetStrips(const char* pcCfgFromCli)
     snprintf(tcPrint, 32, "found %u substrips\r\n", u8cnt);
     APP_TRACE(tcPrint);
     bAppCfg_LockJson();
-    vAppCfg_AddArrayToObject(jAppCfg_Config, "DEVICE_SUBSTRIPS", tu8StripAssembly, u8cnt);
+    vAppCfg_AddArrayToObject(jAppCfg_Config, "DEVICE_SUBSTRIPS", tu16StripAssembly, u8cnt);
     bAppCfg_UnlockJson();
     
     return eRet;
 }
 
+/*******************************************************************************
+ * @brief Set the output ports from the CLI, applied on next boot
+ * @param pcCfgFromCli "<pin>:<leds>,<pin>:<leds>...", 0 leds: rest of the strip
+ ******************************************************************************/
+eApp_RetVal eAppCfg_SetOutputs(const char* pcCfgFromCli)
+{
+    eApp_RetVal eRet = eRet_Ok;
+    char tcPrint[32];
+    uint8_t u8cnt = 0;
+    const char *pcCfg = pcCfgFromCli;
+    JsonDocument jOutputs;
+    JsonArray jArray = jOutputs.to<JsonArray>();
+    while (pcCfg && *pcCfg)
+    {
+        JsonObject jPort = jArray.add<JsonObject>();
+        jPort["PIN"] = atoi(pcCfg);
+        const char *pcLeds = strchr(pcCfg, ':');
+        pcCfg = strchr(pcCfg, ',');
+        jPort["LEDS"] = ((pcLeds != nullptr) && ((pcCfg == nullptr) || (pcLeds < pcCfg))) ? atoi(pcLeds + 1) : 0;
+        pcCfg += (pcCfg != nullptr) ? 1 : 0;
+        u8cnt++;
+    }
+    snprintf(tcPrint, 32, "found %u outputs\r\n", u8cnt);
+    APP_TRACE(tcPrint);
+    if (!u8cnt)
+    { _MNG_RETURN(eRet_BadParameter); }
+    else
+    {
+        bAppCfg_LockJson();
+        jAppCfg_Config["DEVICE_OUTPUTS"] = jArray;
+        bAppCfg_UnlockJson();
+    }
+    return eRet;
+}
+
 eApp_RetVal eAppCfg_SetMqttCfg(uint8_t u8ArgId, const char* pcArgVal)
 {
     eApp_RetVal eRet = eRet_Ok;
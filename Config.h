@@ -21,6 +21,9 @@
 #define APP_WIFI            1 // actiavate wifi tasking
 #define APP_MQTT            1 // activate MQTT tasking
 #define APP_FASTLED         1 // activate ledstrip management
+#define APP_BENCH           1 // activate render benchmark command
+#define APP_TIMING          1 // activate render/transmit timing probes
+#define APP_REALTIME        1 // activate DDP/E1.31 realtime input (needs APP_WIFI)
 #define ESP_LED_PIN         8
 #define APP_PRINT           1
 #define APP_ROOT_TOPIC      "/lumiapp"
@@ -47,6 +50,7 @@ eApp_RetVal eAppCfg_SaveConfig(const char *pcToFilePath);
 eApp_RetVal eAppCfg_SetDefaultConfig(void);
 eApp_RetVal eAppCfg_ResetParamKey(const char* pcObjectKey);
 eApp_RetVal eAppCfg_SetStrips(const char* pcCfgFromCli);
+eApp_RetVal eAppCfg_SetOutputs(const char* pcCfgFromCli);
 eApp_RetVal eAppCfg_SetMqttCfg(uint8_t u8ArgId, const char* pcArgVal);
 bool bAppCfg_LockJson(void);
 bool bAppCfg_UnlockJson(void);
@@ -0,0 +1,188 @@
+/**
+ * @file Kernels.cpp
+ * @brief Pixel kernels used by the SubStrip animations (fade, fill, blend).
+ * @author Nello
+ * @date 2025-10-14
+ */
+
+#include "Kernels.h"
+
+#define _LANES              0x00FF00FFUL
+#define _IS_ALIGNED(p)      ((((uintptr_t)(p)) & 3) == 0)
+#define _IS_ALIGNED_16(p)   ((((uintptr_t)(p)) & 15) == 0)
+
+/******************************************************************************/
+/* Private helpers                                                            */
+/******************************************************************************/
+
+/*******************************************************************************
+ * @brief scale8 of the 4 bytes of a word, k = scale + 1
+ ******************************************************************************/
+static inline uint32_t u32ScaleWord(uint32_t u32Word, uint32_t u32K) {
+    uint32_t u32Lo = (((u32Word & _LANES) * u32K) >> 8) & _LANES;
+    uint32_t u32Hi = (((u32Word >> 8) & _LANES) * u32K) & ~_LANES;
+    return u32Lo | u32Hi;
+}
+
+#if KERNEL_PIE
+/*******************************************************************************
+ * @brief scale8 of 16-byte blocks, ESP32-S3 PIE stub
+ * @details Placeholder of the EE.VLD.128 / EE.VMUL.U8 / EE.VST.128 loop: same
+ *          blocks and alignment, computed with SWAR words meanwhile.
+ * @param pu32 first block, 16-byte aligned
+ * @param u32Blocks number of blocks
+ * @param u32K scale + 1
+ * @return bits set where a byte changed
+ ******************************************************************************/
+static uint32_t u32ScaleBlocks(uint32_t *pu32, uint32_t u32Blocks, uint32_t u32K) {
+    uint32_t u32Diff = 0;
+    for (; u32Blocks; u32Blocks--, pu32 += 4) {
+        for (uint8_t i = 0; i < 4; i++) {
+            uint32_t u32Prev = pu32[i];
+            pu32[i] = u32ScaleWord(u32Prev, u32K);
+            u32Diff |= u32Prev ^ pu32[i];
+        }
+    }
+    return u32Diff;
+}
+#endif
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+
+/*******************************************************************************
+ * @brief Fade pixels toward black, same result as fadeToBlackBy()
+ * @param pLeds pixels to fade
+ * @param u16NbLeds number of pixels
+ * @param u8Fade fade amount
+ * @return true if at least one pixel changed
+ ******************************************************************************/
+bool bKernel_Fade(CRGB *pLeds, uint16_t u16NbLeds, uint8_t u8Fade) {
+    bool bChanged = false;
+#if KERNEL_SWAR
+    uint8_t *pu8 = (uint8_t *)pLeds;
+    uint32_t u32Len = u16NbLeds * sizeof(CRGB);
+    uint32_t u32K = 256 - u8Fade;
+
+    for (; u32Len && !_IS_ALIGNED(pu8); u32Len--, pu8++) {
+        uint8_t u8Prev = *pu8;
+        *pu8 = (uint8_t)((u8Prev * u32K) >> 8);
+        bChanged |= (u8Prev != *pu8);
+    }
+    uint32_t *pu32 = (uint32_t *)pu8;
+    uint32_t u32Diff = 0;
+#if KERNEL_PIE
+    for (; (u32Len >= sizeof(uint32_t)) && !_IS_ALIGNED_16(pu32); u32Len -= sizeof(uint32_t), pu32++) {
+        uint32_t u32Prev = *pu32;
+        *pu32 = u32ScaleWord(u32Prev, u32K);
+        u32Diff |= u32Prev ^ *pu32;
+    }
+    u32Diff |= u32ScaleBlocks(pu32, u32Len / 16, u32K);
+    pu32 += (u32Len / 16) * 4;
+    u32Len %= 16;
+#endif
+    // no branch in the loop, changes are or-ed and tested once
+    uint32_t u32Words = u32Len / sizeof(uint32_t);
+    for (uint32_t i = 0; i < u32Words; i++) {
+        uint32_t u32Prev = pu32[i];
+        pu32[i] = u32ScaleWord(u32Prev, u32K);
+        u32Diff |= u32Prev ^ pu32[i];
+    }
+    bChanged |= (u32Diff != 0);
+    pu32 += u32Words;
+    u32Len -= u32Words * sizeof(uint32_t);
+    pu8 = (uint8_t *)pu32;
+    for (; u32Len; u32Len--, pu8++) {
+        uint8_t u8Prev = *pu8;
+        *pu8 = (uint8_t)((u8Prev * u32K) >> 8);
+        bChanged |= (u8Prev != *pu8);
+    }
+#else
+    for (uint16_t i = 0; i < u16NbLeds; i++) {
+        CRGB xPrev = pLeds[i];
+        pLeds[i].fadeToBlackBy(u8Fade);
+        bChanged |= (xPrev != pLeds[i]);
+    }
+#endif
+    return bChanged;
+}
+
+/*******************************************************************************
+ * @brief Fade listed pixels, same result as bKernel_Fade() on them
+ * @details Pixels reaching black are dropped, the list is compacted in place
+ *          and keeps its order.
+ * @param pLeds pixels
+ * @param pu16Index indexes of the pixels to fade
+ * @param pu16NbIndex number of indexes, updated
+ * @param u8Fade fade amount
+ * @return true if a pixel changed
+ ******************************************************************************/
+bool bKernel_FadeSparse(CRGB *pLeds, uint16_t *pu16Index, uint16_t *pu16NbIndex, uint8_t u8Fade) {
+    bool bChanged = false;
+    uint16_t u16Kept = 0;
+    uint32_t u32K = 256 - u8Fade;
+    if (!u8Fade)
+    { return false; }
+    for (uint16_t i = 0; i < *pu16NbIndex; i++) {
+        CRGB *pPixel = &pLeds[pu16Index[i]];
+        CRGB xPrev = *pPixel;
+        pPixel->r = (uint8_t)((xPrev.r * u32K) >> 8);
+        pPixel->g = (uint8_t)((xPrev.g * u32K) >> 8);
+        pPixel->b = (uint8_t)((xPrev.b * u32K) >> 8);
+        bChanged |= (xPrev != *pPixel);
+        if (*pPixel)
+        { pu16Index[u16Kept++] = pu16Index[i]; }
+    }
+    *pu16NbIndex = u16Kept;
+    return bChanged;
+}
+
+/*******************************************************************************
+ * @brief Scale pixels, same result as nscale8()
+ * @param pLeds pixels to scale
+ * @param u16NbLeds number of pixels
+ * @param u8Scale scale, 255: unchanged
+ ******************************************************************************/
+void vKernel_Scale(CRGB *pLeds, uint16_t u16NbLeds, uint8_t u8Scale) {
+    bKernel_Fade(pLeds, u16NbLeds, 255 - u8Scale);
+}
+
+/*******************************************************************************
+ * @brief Fill pixels with a color, same result as fill_solid()
+ * @param pLeds pixels to fill
+ * @param u16NbLeds number of pixels
+ * @param xColor fill color
+ ******************************************************************************/
+void vKernel_Fill(CRGB *pLeds, uint16_t u16NbLeds, CRGB xColor) {
+#if KERNEL_SWAR
+    uint8_t *pu8 = (uint8_t *)pLeds;
+    uint32_t u32Len = u16NbLeds * sizeof(CRGB);
+    const uint8_t tu8Color[3] = {xColor.raw[0], xColor.raw[1], xColor.raw[2]};
+    uint8_t u8Phase = 0;
+
+    for (; u32Len && !_IS_ALIGNED(pu8); u32Len--, pu8++) {
+        *pu8 = tu8Color[u8Phase];
+        u8Phase = (u8Phase == 2) ? 0 : (u8Phase + 1);
+    }
+    // 4 pixels = 3 words, pattern starts at the current phase
+    uint32_t tu32Pattern[3];
+    uint8_t *pu8Pattern = (uint8_t *)tu32Pattern;
+    for (uint8_t i = 0; i < sizeof(tu32Pattern); i++) {
+        pu8Pattern[i] = tu8Color[(u8Phase + i) % 3];
+    }
+    uint32_t *pu32 = (uint32_t *)pu8;
+    for (; u32Len >= sizeof(tu32Pattern); u32Len -= sizeof(tu32Pattern)) {
+        *pu32++ = tu32Pattern[0];
+        *pu32++ = tu32Pattern[1];
+        *pu32++ = tu32Pattern[2];
+    }
+    pu8 = (uint8_t *)pu32;
+    for (; u32Len; u32Len--, pu8++) {
+        *pu8 = tu8Color[u8Phase];
+        u8Phase = (u8Phase == 2) ? 0 : (u8Phase + 1);
+    }
+#else
+    fill_solid(pLeds, u16NbLeds, xColor);
+#endif
+}
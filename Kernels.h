@@ -0,0 +1,86 @@
+/**
+ * @file Kernels.h
+ * @brief Pixel kernels used by the SubStrip animations (fade, fill, blend).
+ * @author Nello
+ * @date 2025-10-14
+ */
+
+#ifndef _KERNELS_H
+#define _KERNELS_H
+
+#include <FastLED.h>
+#include <stdint.h>
+
+/*
+ * KERNEL_SWAR 1: RGB bytes are processed a 32-bit word (4 channels) at a time,
+ * two 16-bit lanes per multiply. Results are bit-exact with the FastLED scalar
+ * functions they replace (FASTLED_SCALE8_FIXED / FASTLED_BLEND_FIXED), which
+ * are used instead when KERNEL_SWAR is 0. On a host, the SWAR fade, change
+ * report included, runs as fast as a bare fadeToBlackBy() loop and twice as
+ * fast as the scalar path (make -C test). The one-pixel blend does not win
+ * there: packing the pixel into a word costs what the multiplies save, so
+ * KERNEL_SWAR_BLEND keeps it to the ESP32, whose core has no SIMD.
+ * KERNEL_PIE 1: ESP32-S3 path for the 128-bit PIE instructions, selected on
+ * that target. Stub for now: the fade takes 16-byte blocks but runs them
+ * through SWAR words until the EE.VMUL.U8 sequence is written; same results.
+ */
+#ifndef KERNEL_SWAR
+#define KERNEL_SWAR         1
+#endif
+
+#ifndef KERNEL_SWAR_BLEND
+#if KERNEL_SWAR && (defined(ARDUINO_ARCH_ESP32) || defined(ESP_PLATFORM))
+#define KERNEL_SWAR_BLEND   1
+#else
+#define KERNEL_SWAR_BLEND   0
+#endif
+#endif
+
+#ifndef KERNEL_PIE
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+#define KERNEL_PIE          1
+#else
+#define KERNEL_PIE          0
+#endif
+#endif
+
+#if KERNEL_PIE && !KERNEL_SWAR
+#error "KERNEL_PIE builds on the KERNEL_SWAR words"
+#endif
+
+bool bKernel_Fade(CRGB *pLeds, uint16_t u16NbLeds, uint8_t u8Fade);
+bool bKernel_FadeSparse(CRGB *pLeds, uint16_t *pu16Index, uint16_t *pu16NbIndex, uint8_t u8Fade);
+void vKernel_Scale(CRGB *pLeds, uint16_t u16NbLeds, uint8_t u8Scale);
+void vKernel_Fill(CRGB *pLeds, uint16_t u16NbLeds, CRGB xColor);
+
+/*******************************************************************************
+ * @brief blend8 of the 4 bytes of two words, (a*(256-amount) + b*(amount+1)) >> 8
+ ******************************************************************************/
+static inline uint32_t u32Kernel_BlendWord(uint32_t u32A, uint32_t u32B, uint32_t u32Amount) {
+    const uint32_t u32Lanes = 0x00FF00FFUL;
+    uint32_t u32Ka = 256 - u32Amount;
+    uint32_t u32Kb = u32Amount + 1;
+    uint32_t u32Lo = ((((u32A & u32Lanes) * u32Ka) + ((u32B & u32Lanes) * u32Kb)) >> 8) & u32Lanes;
+    uint32_t u32Hi = ((((u32A >> 8) & u32Lanes) * u32Ka) + (((u32B >> 8) & u32Lanes) * u32Kb)) & ~u32Lanes;
+    return u32Lo | u32Hi;
+}
+
+/*******************************************************************************
+ * @brief Blend one pixel, same result as blend(): for compositing loops that
+ *        fold several sources per pixel (layers, crossfade)
+ * @param xA pixel below
+ * @param xB pixel blended in
+ * @param u8Amount amount of xB, 0: xA, 255: xB
+ ******************************************************************************/
+static inline CRGB xKernel_BlendPixel(const CRGB &xA, const CRGB &xB, uint8_t u8Amount) {
+#if KERNEL_SWAR_BLEND
+    uint32_t u32A = ((uint32_t)xA.b << 16) | ((uint32_t)xA.g << 8) | xA.r;
+    uint32_t u32B = ((uint32_t)xB.b << 16) | ((uint32_t)xB.g << 8) | xB.r;
+    uint32_t u32Mix = u32Kernel_BlendWord(u32A, u32B, u8Amount);
+    return CRGB((uint8_t)u32Mix, (uint8_t)(u32Mix >> 8), (uint8_t)(u32Mix >> 16));
+#else
+    return blend(xA, xB, u8Amount);
+#endif
+}
+
+#endif // _KERNELS_H
@@ -0,0 +1,117 @@
+/**
+ * @file LedOutput.cpp
+ * @brief Output drivers: transmit the composed ledstrip to the data pins.
+ * @author Nello
+ * @date 2025-10-14
+ */
+
+#include <Arduino.h>
+#include "LedOutput.h"
+
+/*******************************************************************************
+ *  CONFIGURATION
+ ******************************************************************************/
+#define LED_CHIPSET         WS2812
+#define LED_PIXEL_ORDER     GRB
+
+#define _MNG_RETURN(x)      eRet = x
+
+/*******************************************************************************
+ *  GLOBAL VARIABLES
+ ******************************************************************************/
+static CLEDController *tpLedOutput_Controllers[LED_OUTPUT_MAX];
+
+/*******************************************************************************
+ * @brief Driver selected at build time
+ ******************************************************************************/
+const TstLedOutput_Driver *pLedOutput_GetDriver(void) {
+#if LED_OUTPUT_SIM
+    return &stLedOutput_Sim;
+#else
+    return &stLedOutput_FastLed;
+#endif
+}
+
+/******************************************************************************/
+/* FastLED driver                                                             */
+/******************************************************************************/
+
+/*******************************************************************************
+ * @brief One FastLED controller per port, FastLED.show() drives them together
+ ******************************************************************************/
+static eApp_RetVal eLedOutput_FastLedInit(CRGB *pLeds, const TstLedOutput_Port *pstPorts, uint8_t u8NbPorts) {
+    eApp_RetVal eRet = eLedOutput_SetLayout(pstPorts, u8NbPorts);
+    CRGB *pPortLeds = pLeds;
+    for (uint8_t i = 0; (i < u8NbPorts) && (eRet >= eRet_Ok); i++) {
+        CLEDController *pController = nullptr;
+#define GENERATE_PIN_CASE(PIN)      \
+        case PIN: pController = &FastLED.addLeds<LED_CHIPSET, PIN, LED_PIXEL_ORDER>(pPortLeds, pstPorts[i].u16NbLeds); break;
+        switch (pstPorts[i].u8Pin) {
+            FOREACH_LED_OUTPUT_PIN(GENERATE_PIN_CASE)
+
+            default:
+            _MNG_RETURN(eRet_BadParameter);
+            break;
+        }
+#undef GENERATE_PIN_CASE
+        tpLedOutput_Controllers[i] = pController;
+        pPortLeds += pstPorts[i].u16NbLeds;
+    }
+    return eRet;
+}
+
+static void vLedOutput_FastLedSetLeds(CRGB *pLeds) {
+    const TstLedOutput_Port *pstPorts;
+    uint8_t u8NbPorts = u8LedOutput_GetPorts(&pstPorts);
+    for (uint8_t i = 0; i < u8NbPorts; i++) {
+        tpLedOutput_Controllers[i]->setLeds(pLeds, pstPorts[i].u16NbLeds);
+        pLeds += pstPorts[i].u16NbLeds;
+    }
+}
+
+static void vLedOutput_FastLedShow(void) {
+    FastLED.show();
+}
+
+const TstLedOutput_Driver stLedOutput_FastLed = {
+    "fastled",
+    eLedOutput_FastLedInit,
+    vLedOutput_FastLedSetLeds,
+    vLedOutput_FastLedShow,
+    u32LedOutput_GetWireUs,
+};
+
+/******************************************************************************/
+/* Simulated driver                                                           */
+/******************************************************************************/
+
+/*******************************************************************************
+ * @brief Nothing is bound, only the layout is kept to model the wire time
+ ******************************************************************************/
+static eApp_RetVal eLedOutput_SimInit(CRGB *pLeds, const TstLedOutput_Port *pstPorts, uint8_t u8NbPorts) {
+    return (pLeds == nullptr) ? eRet_BadParameter : eLedOutput_SetLayout(pstPorts, u8NbPorts);
+}
+
+static void vLedOutput_SimSetLeds(CRGB *pLeds) {
+    (void)pLeds;
+}
+
+/*******************************************************************************
+ * @brief Block for the time the longest port would take on the wire
+ ******************************************************************************/
+static void vLedOutput_SimShow(void) {
+    uint32_t u32WireUs = u32LedOutput_GetWireUs();
+    if (u32WireUs >= 1000) {
+        vTaskDelay(pdMS_TO_TICKS(u32WireUs / 1000));
+        u32WireUs %= 1000;
+    }
+    delayMicroseconds(u32WireUs);
+}
+
+const TstLedOutput_Driver stLedOutput_Sim = {
+    "sim",
+    eLedOutput_SimInit,
+    vLedOutput_SimSetLeds,
+    vLedOutput_SimShow,
+    u32LedOutput_GetWireUs,
+};
@@ -0,0 +1,90 @@
+/**
+ * @file LedOutput.h
+ * @brief Output drivers: transmit the composed ledstrip to the data pins.
+ * @author Nello
+ * @date 2025-10-14
+ */
+
+#ifndef _LED_OUTPUT_H
+#define _LED_OUTPUT_H
+
+#include <FastLED.h>
+#include <stdint.h>
+#include "Typedefs.h"
+
+/*
+ * LED_OUTPUT_SIM 1: the simulated driver is used instead of FastLED, nothing
+ * is transmitted, show() only waits for the modeled wire time.
+ */
+#ifndef LED_OUTPUT_SIM
+#define LED_OUTPUT_SIM      0
+#endif
+
+#define LED_OUTPUT_MAX      8 // ports, one RMT channel each
+#define LED_OUTPUT_WIRE_US(n)   ((uint32_t)(n) * 30 + 50) // WS2812: 24 bits * 1.25us per led + latch
+
+/*
+ * Current model of a WS2812 at 5V, as FastLED's power functions: full scale
+ * current of each channel and the quiescent current of a dark LED, in mA.
+ * The color correction is not taken into account, the estimate is high.
+ */
+#define LED_OUTPUT_MA_RED       16
+#define LED_OUTPUT_MA_GREEN     11
+#define LED_OUTPUT_MA_BLUE      15
+#define LED_OUTPUT_MA_IDLE      1
+
+/*
+ * Data pins a port can use. FastLED takes the pin as a template parameter,
+ * each listed pin instantiates one controller type.
+ */
+#define FOREACH_LED_OUTPUT_PIN(PIN)     \
+    PIN(2)                              \
+    PIN(4)                              \
+    PIN(5)                              \
+    PIN(18)                             \
+    PIN(19)                             \
+    PIN(21)                             \
+    PIN(22)                             \
+    PIN(23)
+
+/*
+ * A port drives u16NbLeds consecutive pixels of the ledstrip, ports follow
+ * each other in the ledstrip. All ports are transmitted in parallel.
+ */
+typedef struct {
+    uint8_t u8Pin;
+    uint16_t u16NbLeds;
+} TstLedOutput_Port;
+
+/*
+ * Driver interface:
+ *  - peInit(): bind the ports to the given ledstrip
+ *  - pvSetLeds(): present another buffer with the same layout
+ *  - pvShow(): transmit the presented buffer, returns once on the wire
+ *  - pu32GetWireUs(): wire time of one show, longest port
+ */
+typedef struct {
+    const char *pcName;
+    eApp_RetVal (*peInit)(CRGB *pLeds, const TstLedOutput_Port *pstPorts, uint8_t u8NbPorts);
+    void (*pvSetLeds)(CRGB *pLeds);
+    void (*pvShow)(void);
+    uint32_t (*pu32GetWireUs)(void);
+} TstLedOutput_Driver;
+
+extern const TstLedOutput_Driver stLedOutput_FastLed;
+extern const TstLedOutput_Driver stLedOutput_Sim;
+
+const TstLedOutput_Driver *pLedOutput_GetDriver(void);
+
+/*
+ * Wire time model (LedOutput_Wire.cpp), shared by the drivers: the layout set
+ * by a driver's peInit() and the time its longest port takes on the wire.
+ * Plain computations, built on a host by the tests.
+ */
+bool bLedOutput_IsValidPin(uint8_t u8Pin);
+eApp_RetVal eLedOutput_SetLayout(const TstLedOutput_Port *pstPorts, uint8_t u8NbPorts);
+uint8_t u8LedOutput_GetPorts(const TstLedOutput_Port **ppstPorts);
+uint32_t u32LedOutput_GetWireUs(void);
+uint16_t u16LedOutput_GetMaxFps(void);
+
+#endif // _LED_OUTPUT_H
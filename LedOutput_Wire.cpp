@@ -0,0 +1,78 @@
+/**
+ * @file LedOutput_Wire.cpp
+ * @brief Port layout and wire time model of the output drivers.
+ * @author Nello
+ * @date 2025-10-14
+ *
+ * No Arduino nor FreeRTOS call: shared by the drivers and built on a host by
+ * the tests (make -C test).
+ */
+
+#include "LedOutput.h"
+
+#define _MNG_RETURN(x)      eRet = x
+
+/*******************************************************************************
+ *  GLOBAL VARIABLES
+ ******************************************************************************/
+static TstLedOutput_Port tstLedOutput_Ports[LED_OUTPUT_MAX];
+static uint8_t u8LedOutput_NbPorts = 0;
+static uint32_t u32LedOutput_WireUs = 0;
+
+/*******************************************************************************
+ * @brief Check that a data pin is listed in FOREACH_LED_OUTPUT_PIN
+ ******************************************************************************/
+bool bLedOutput_IsValidPin(uint8_t u8Pin) {
+#define GENERATE_PIN_CHECK(PIN)     case PIN:
+    switch (u8Pin) {
+        FOREACH_LED_OUTPUT_PIN(GENERATE_PIN_CHECK)
+        return true;
+
+        default:
+        return false;
+    }
+#undef GENERATE_PIN_CHECK
+}
+
+/*******************************************************************************
+ * @brief Store the port layout and its wire time
+ ******************************************************************************/
+eApp_RetVal eLedOutput_SetLayout(const TstLedOutput_Port *pstPorts, uint8_t u8NbPorts) {
+    eApp_RetVal eRet = eRet_Ok;
+    if ((pstPorts == nullptr) || !u8NbPorts || (u8NbPorts > LED_OUTPUT_MAX)) {
+        _MNG_RETURN(eRet_BadParameter);
+    }
+    else {
+        u32LedOutput_WireUs = 0;
+        for (uint8_t i = 0; i < u8NbPorts; i++) {
+            tstLedOutput_Ports[i] = pstPorts[i];
+            // ports are transmitted in parallel, the longest one sets the pace
+            if (LED_OUTPUT_WIRE_US(pstPorts[i].u16NbLeds) > u32LedOutput_WireUs)
+            { u32LedOutput_WireUs = LED_OUTPUT_WIRE_US(pstPorts[i].u16NbLeds); }
+        }
+        u8LedOutput_NbPorts = u8NbPorts;
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Ports of the layout
+ * @param ppstPorts set to the ports, in ledstrip order
+ * @return number of ports, 0 before a layout is set
+ ******************************************************************************/
+uint8_t u8LedOutput_GetPorts(const TstLedOutput_Port **ppstPorts) {
+    *ppstPorts = tstLedOutput_Ports;
+    return u8LedOutput_NbPorts;
+}
+
+uint32_t u32LedOutput_GetWireUs(void) {
+    return u32LedOutput_WireUs;
+}
+
+/*******************************************************************************
+ * @brief Highest frame rate the layout allows, one show per wire time
+ * @return frames per second, 0 before a layout is set
+ ******************************************************************************/
+uint16_t u16LedOutput_GetMaxFps(void) {
+    return u32LedOutput_WireUs ? (uint16_t)(1000000UL / u32LedOutput_WireUs) : 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file OutputLut.cpp
+ * @brief Implementation of the OutputLut class.
+ * @author Nello
+ * @date 2025-12-19
+ */
+
+#include "OutputLut.h"
+#include <math.h>
+
+/*******************************************************************************
+ * @brief Constructor for the OutputLut class, identity table
+ ******************************************************************************/
+OutputLut::OutputLut() {
+    vSetGamma(100);
+    vBuild(CRGB(255, 255, 255), 255);
+}
+
+/*******************************************************************************
+ * @brief Compute the gamma curve, the table is rebuilt by vBuild()
+ * @param u16Gamma100 gamma x100, 100 for a linear output
+ ******************************************************************************/
+void OutputLut::vSetGamma(uint16_t u16Gamma100) {
+    float fGamma = (float)u16Gamma100 / 100.0f;
+    for (uint16_t i = 0; i < OUTPUT_LUT_SIZE; i++) {
+        _tu8Gamma[i] = (uint8_t)(powf((float)i / 255.0f, fGamma) * 255.0f + 0.5f);
+    }
+    _u16Gamma100 = u16Gamma100;
+}
+
+/*******************************************************************************
+ * @brief Build the channel tables from the gamma curve
+ * @param xBalance full scale of each channel, white balance
+ * @param u8Brightness global brightness
+ ******************************************************************************/
+void OutputLut::vBuild(CRGB xBalance, uint8_t u8Brightness) {
+    for (uint8_t c = 0; c < 3; c++) {
+        // balance and brightness: one Q16 factor per channel
+        uint32_t u32Scale = ((uint32_t)xBalance.raw[c] + 1) * ((uint32_t)u8Brightness + 1);
+        for (uint16_t i = 0; i < OUTPUT_LUT_SIZE; i++) {
+            _tu8Lut[c][i] = (uint8_t)(((uint32_t)_tu8Gamma[i] * u32Scale) >> 16);
+        }
+    }
+    _u8Brightness = u8Brightness;
+}
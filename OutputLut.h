@@ -0,0 +1,45 @@
+/**
+ * @file OutputLut.h
+ * @brief Header file for the OutputLut class.
+ * @author Nello
+ * @date 2025-12-19
+ */
+
+#ifndef _OUTPUT_LUT_H
+#define _OUTPUT_LUT_H
+
+#include <FastLED.h>
+#include <stdint.h>
+
+#define OUTPUT_LUT_SIZE         256
+#define OUTPUT_LUT_GAMMA_DEF    220 // gamma x100
+#define OUTPUT_LUT_GAMMA_MAX    400
+#define OUTPUT_LUT_WB_DEF       0xFFB0F0 // white balance, FastLED TypicalLEDStrip
+
+/*
+ * Output stage of the pixels: gamma, white balance and brightness fused in one
+ * table per channel, out = brightness * balance * gamma(in). The gamma curve
+ * is computed when the gamma changes; a brightness or balance change only
+ * rebuilds the 3 x 256 entries with integer math, never while rendering.
+ */
+class OutputLut {
+public:
+    OutputLut();
+    void vSetGamma(uint16_t u16Gamma100);
+    void vBuild(CRGB xBalance, uint8_t u8Brightness);
+
+    uint16_t u16GetGamma(void) const { return _u16Gamma100; }
+    uint8_t u8GetBrightness(void) const { return _u8Brightness; }
+    CRGB xApply(const CRGB &xPixel) const {
+        return CRGB(_tu8Lut[0][xPixel.r], _tu8Lut[1][xPixel.g], _tu8Lut[2][xPixel.b]);
+    }
+    uint8_t u8Apply(uint8_t u8Channel, uint8_t u8Value) const { return _tu8Lut[u8Channel][u8Value]; }
+
+private:
+    uint8_t _tu8Gamma[OUTPUT_LUT_SIZE];
+    uint8_t _tu8Lut[3][OUTPUT_LUT_SIZE];
+    uint16_t _u16Gamma100;
+    uint8_t _u8Brightness;
+};
+
+#endif // _OUTPUT_LUT_H
@@ -0,0 +1,92 @@
+/**
+ * @file Palette.cpp
+ * @brief Implementation of the Palette class.
+ * @author Nello
+ * @date 2025-10-14
+ */
+
+#include "Palette.h"
+
+#define _MNG_RETURN(x)  eRet = x
+
+/*******************************************************************************
+ * @brief Constructor for the Palette class, empty palette.
+ ******************************************************************************/
+Palette::Palette() {
+    _u8Revision = 0;
+    vClear();
+}
+
+/*******************************************************************************
+ * @brief Load colors and build the lookup table
+ * @param pColors colors to copy
+ * @param u8NbColors [1-PALETTE_MAX_COLORS] number of colors
+ ******************************************************************************/
+Palette::TeRetVal Palette::eLoad(const CRGB *pColors, uint8_t u8NbColors) {
+    TeRetVal eRet = RET_OK;
+    if ((pColors == nullptr) || !u8NbColors || (u8NbColors > PALETTE_MAX_COLORS)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        memcpy(_tColors, pColors, u8NbColors * sizeof(CRGB));
+        _u8NbColors = u8NbColors;
+        vBuildLut();
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Replace or append one color and rebuild the lookup table
+ * @param u8Index index of the color, at most the current number of colors
+ * @param xColor new color
+ ******************************************************************************/
+Palette::TeRetVal Palette::eSetColor(uint8_t u8Index, CRGB xColor) {
+    TeRetVal eRet = RET_OK;
+    if ((u8Index > _u8NbColors) || (u8Index >= PALETTE_MAX_COLORS)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        _tColors[u8Index] = xColor;
+        if (u8Index == _u8NbColors)
+        { _u8NbColors++; }
+        vBuildLut();
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Remove all colors
+ ******************************************************************************/
+void Palette::vClear(void) {
+    _u8NbColors = 0;
+    memset(_tColors, 0, sizeof(_tColors));
+    memset(_tLut, 0, sizeof(_tLut));
+    _u8Revision++;
+}
+
+/*******************************************************************************
+ * @brief Span of the lookup table between two consecutive colors
+ * @return number of LUT entries from color i to color i + 1
+ ******************************************************************************/
+uint8_t Palette::u8GetSegment(void) const {
+    return (_u8NbColors > 1) ? (255 / (_u8NbColors - 1)) : 255;
+}
+
+/*******************************************************************************
+ * @brief Build the lookup table: linear blend between consecutive colors
+ ******************************************************************************/
+void Palette::vBuildLut(void) {
+    uint8_t u8Last = _u8NbColors - 1;
+    for (uint16_t i = 0; i < PALETTE_LUT_SIZE; i++) {
+        // Q8 position along the colors
+        uint16_t u16Pos = (uint16_t)(((uint32_t)i * u8Last * 256) / 255);
+        uint8_t u8Seg = u16Pos >> 8;
+        if (u8Seg >= u8Last) {
+            _tLut[i] = _tColors[u8Last];
+        }
+        else {
+            _tLut[i] = blend(_tColors[u8Seg], _tColors[u8Seg + 1], (fract8)(u16Pos & 0xFF));
+        }
+    }
+    _u8Revision++;
+}
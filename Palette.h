@@ -0,0 +1,50 @@
+/**
+ * @file Palette.h
+ * @brief Header file for the Palette class.
+ * @author Nello
+ * @date 2025-10-14
+ */
+
+#ifndef _PALETTE_H
+#define _PALETTE_H
+
+#include <FastLED.h>
+#include <stdint.h>
+
+#define PALETTE_MAX_COLORS         30 // as the former black terminated lists
+#define PALETTE_LUT_SIZE           256
+
+/*
+ * Color list with an explicit count and a 256 entries lookup table, blended
+ * linearly from the first color (index 0) to the last one (index 255).
+ * The table is built when colors are loaded or edited, never while rendering.
+ * Sub-strips hold a palette by reference, several may share the same one.
+ */
+class Palette {
+public:
+    typedef enum {
+        RET_OK                  = 0,
+        RET_GENERIC_ERROR       = -1,
+        RET_BAD_PARAMETER       = RET_GENERIC_ERROR - 1,
+    } TeRetVal;
+
+    Palette();
+    TeRetVal eLoad(const CRGB *pColors, uint8_t u8NbColors);
+    TeRetVal eSetColor(uint8_t u8Index, CRGB xColor);
+    void vClear(void);
+
+    uint8_t u8GetNbColors(void) const { return _u8NbColors; }
+    const CRGB *pGetColors(void) const { return _tColors; }
+    const CRGB &xSample(uint8_t u8Index) const { return _tLut[u8Index]; }
+    uint8_t u8GetSegment(void) const; // LUT span between two consecutive colors
+    uint8_t u8GetRevision(void) const { return _u8Revision; }
+
+private:
+    CRGB _tColors[PALETTE_MAX_COLORS];
+    CRGB _tLut[PALETTE_LUT_SIZE];
+    uint8_t _u8NbColors;
+    uint8_t _u8Revision; // incremented on each change
+    void vBuildLut(void);
+};
+
+#endif // _PALETTE_H
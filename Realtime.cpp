@@ -0,0 +1,571 @@
+/**
+ * @file Realtime.cpp
+ * @brief Implementation of the Realtime class.
+ * @author Nello
+ * @date 2026-01-12
+ */
+
+#include "Realtime.h"
+#include <string.h>
+#if defined(ESP_PLATFORM)
+#include "lwip/sockets.h"
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+#include <unistd.h>
+
+#define _MNG_RETURN(x)  eRet = x
+#define GENERATE_REALTIME_STR(ENUM, NAME)   #NAME,
+
+// DDP: flags, sequence, data type, id, offset (32), length (16), [timecode]
+#define _DDP_HEADER             10
+#define _DDP_HEADER_TIMECODE    14
+#define _DDP_VERSION_MASK       0xC0
+#define _DDP_VERSION_1          0x40
+#define _DDP_FLAG_TIMECODE      0x10
+#define _DDP_FLAG_STORAGE       0x08
+#define _DDP_FLAG_REPLY         0x04
+#define _DDP_FLAG_QUERY         0x02
+#define _DDP_FLAG_PUSH          0x01
+#define _DDP_ID_DISPLAY         1
+#define _DDP_ID_ALL             255
+#define _DDP_PRIORITY           100 // E1.31 default, DDP has none
+
+// E1.31: root layer, then framing and DMP layers of a data packet
+#define _E131_ROOT_DATA         0x00000004
+#define _E131_ROOT_EXTENDED     0x00000008
+#define _E131_FRAMING_DATA      0x00000002
+#define _E131_FRAMING_SYNC      0x00000001
+#define _E131_DMP_SET_PROPERTY  0x02
+#define _E131_DMP_ADDRESS_TYPE  0xA1
+#define _E131_OPT_PREVIEW       0x80
+#define _E131_OPT_TERMINATED    0x40
+#define _E131_ROOT_LEN          38
+#define _E131_SYNC_LEN          49
+#define _E131_DATA_HEADER       126 // channels start after the start code
+#define _E131_MAX_CHANNELS      512
+#define _E131_MAX_UNIVERSE      63999
+#define _E131_SEQ_WINDOW        -20 // older by less than 20: out of order
+
+static const uint8_t Ctu8Realtime_AcnId[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+static const char *CtcRealtime_Drops[] = {
+    FOREACH_REALTIME_DROP(GENERATE_REALTIME_STR)
+};
+
+static inline uint16_t u16Be(const uint8_t *pu8) { return ((uint16_t)pu8[0] << 8) | pu8[1]; }
+static inline uint32_t u32Be(const uint8_t *pu8) { return ((uint32_t)u16Be(pu8) << 16) | u16Be(pu8 + 2); }
+
+/*******************************************************************************
+ * @brief Constructor for the Realtime class, closed and unconfigured
+ ******************************************************************************/
+Realtime::Realtime() {
+    _iDdpSocket = -1;
+    _iE131Socket = -1;
+    _bPreferE131 = false;
+    _u16DdpPort = 0;
+    _u16E131Port = 0;
+    _u16Universe = 1;
+    _u8NbUniverses = 0;
+    _u32FrameBytes = 0;
+    _u16TimeoutMs = REALTIME_TIMEOUT_MS;
+    memset(&_stCounters, 0, sizeof(_stCounters));
+    vRelease();
+}
+
+Realtime::~Realtime() {
+    vClose();
+}
+
+/*******************************************************************************
+ * @brief Set the input, taken into account by the next eOpen()
+ * @param u16DdpPort DDP port, 0 to disable DDP
+ * @param u16E131Port E1.31 port, 0 to disable E1.31
+ * @param u16Universe first E1.31 universe, 1 to 63999
+ * @param u32FrameBytes size of the frames given to eReceive()
+ ******************************************************************************/
+Realtime::TeRetVal Realtime::eConfigure(uint16_t u16DdpPort, uint16_t u16E131Port, uint16_t u16Universe, uint32_t u32FrameBytes) {
+    TeRetVal eRet = RET_OK;
+    if ((!u16DdpPort && !u16E131Port) || !u32FrameBytes || !u16Universe || (u16Universe > _E131_MAX_UNIVERSE)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        uint32_t u32NbUniverses = (u32FrameBytes + REALTIME_UNIVERSE_BYTES - 1) / REALTIME_UNIVERSE_BYTES;
+        u32NbUniverses = (u32NbUniverses < REALTIME_MAX_UNIVERSES) ? u32NbUniverses : REALTIME_MAX_UNIVERSES;
+        u32NbUniverses = ((u16Universe + u32NbUniverses - 1) <= _E131_MAX_UNIVERSE) ? u32NbUniverses : (_E131_MAX_UNIVERSE - u16Universe + 1);
+        _u16DdpPort = u16DdpPort;
+        _u16E131Port = u16E131Port;
+        _u16Universe = u16Universe;
+        _u8NbUniverses = (uint8_t)u32NbUniverses;
+        _u32FrameBytes = u32FrameBytes;
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Set the silence after which the owning source is lost
+ * @param u16TimeoutMs milliseconds, not null
+ ******************************************************************************/
+Realtime::TeRetVal Realtime::eSetTimeout(uint16_t u16TimeoutMs) {
+    TeRetVal eRet = RET_OK;
+    if (!u16TimeoutMs) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        _u16TimeoutMs = u16TimeoutMs;
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Bind the sockets of the configured protocols
+ * @details E1.31 joins the multicast group of each universe of the frame;
+ *          a refused join leaves unicast working.
+ ******************************************************************************/
+Realtime::TeRetVal Realtime::eOpen(void) {
+    TeRetVal eRet = RET_OK;
+    vClose();
+    if (!_u32FrameBytes) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        if (_u16DdpPort) {
+            _iDdpSocket = iOpenSocket(_u16DdpPort);
+        }
+        if (_u16E131Port) {
+            _iE131Socket = iOpenSocket(_u16E131Port);
+            for (uint8_t u = 0; (_iE131Socket >= 0) && (u < _u8NbUniverses); u++) {
+                // 239.255.<universe high>.<universe low>
+                uint16_t u16Universe = _u16Universe + u;
+                struct ip_mreq stGroup;
+                stGroup.imr_multiaddr.s_addr = htonl(0xEFFF0000UL | u16Universe);
+                stGroup.imr_interface.s_addr = htonl(INADDR_ANY);
+                setsockopt(_iE131Socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &stGroup, sizeof(stGroup));
+            }
+        }
+        if ((_u16DdpPort && (_iDdpSocket < 0)) || (_u16E131Port && (_iE131Socket < 0))) {
+            _MNG_RETURN(RET_GENERIC_ERROR);
+        }
+    }
+    return eRet;
+}
+
+void Realtime::vClose(void) {
+    if (_iDdpSocket >= 0) {
+        close(_iDdpSocket);
+        _iDdpSocket = -1;
+    }
+    if (_iE131Socket >= 0) {
+        close(_iE131Socket);
+        _iE131Socket = -1;
+    }
+    vRelease();
+}
+
+/*******************************************************************************
+ * @brief Wait for a packet the output could be handed to
+ * @details Invalid packets are dropped, a valid one stays queued for
+ *          eReceive(); its source owns the output from now on.
+ * @param u32Now current time in milliseconds
+ * @param u32WaitMs longest wait
+ * @return true when a valid packet is waiting
+ ******************************************************************************/
+bool Realtime::bPoll(uint32_t u32Now, uint32_t u32WaitMs) {
+    bool bValid = false;
+    int iSocket = iReadable(u32WaitMs);
+    if (iSocket >= 0) {
+        TstPacket stPacket;
+        TeDrop eDrop = eInspect(iSocket, u32Now, &stPacket);
+        if (eDrop < NB_DROPS) {
+            _stCounters.tu32Drops[eDrop]++;
+            vConsume(iSocket);
+        }
+        else if (stPacket.bTerminated || stPacket.bSync) {
+            vConsume(iSocket); // nothing to show
+            if (stPacket.bTerminated)
+            { vRelease(); }
+        }
+        else {
+            bValid = true;
+        }
+    }
+    return bValid;
+}
+
+/*******************************************************************************
+ * @brief Receive one packet into the frame
+ * @param pu8Frame frame of the configured size, RGB bytes
+ * @param u32Now current time in milliseconds
+ * @param u32WaitMs longest wait for a packet
+ * @return EVENT_FRAME: the frame is complete and must be shown before the
+ *         next call, which starts a new frame in the buffer it is given
+ ******************************************************************************/
+Realtime::TeEvent Realtime::eReceive(uint8_t *pu8Frame, uint32_t u32Now, uint32_t u32WaitMs) {
+    TeEvent eEvent = EVENT_NONE;
+    int iSocket = iReadable(u32WaitMs);
+    if ((iSocket >= 0) && (pu8Frame != nullptr)) {
+        TstPacket stPacket;
+        TeDrop eDrop = eInspect(iSocket, u32Now, &stPacket);
+        uint32_t u32Bit = (uint32_t)1 << stPacket.u8Universe;
+        eEvent = EVENT_PACKET;
+        if (eDrop < NB_DROPS) {
+            _stCounters.tu32Drops[eDrop]++;
+            vConsume(iSocket);
+        }
+        else if (stPacket.bTerminated) {
+            vConsume(iSocket);
+            vRelease(); // stream stopped on purpose, no timeout to wait for
+        }
+        else if (stPacket.bSync) {
+            vConsume(iSocket);
+            _stCounters.u32Syncs++;
+            if (_bPending && _u16Sync && (stPacket.u16Sync == _u16Sync)) {
+                vNewFrame();
+                eEvent = EVENT_FRAME;
+            }
+        }
+        else if (_bPending && ((stPacket.bE131 ? (_u32Universes & u32Bit) : (stPacket.u32Offset < _u32Watermark)) ||
+                               (_u8NbRanges >= REALTIME_MAX_RANGES))) {
+            // new frame before the end of this one (lost push or sync), or
+            // too scattered to be reported: show what was received, the
+            // packet stays queued
+            vNewFrame();
+            eEvent = EVENT_FRAME;
+        }
+        else {
+            struct iovec tIov[2];
+            struct msghdr stMsg;
+            tIov[0].iov_base = _tu8Header;
+            tIov[0].iov_len = stPacket.u16Header;
+            tIov[1].iov_base = pu8Frame + stPacket.u32Offset;
+            tIov[1].iov_len = stPacket.u16Length;
+            memset(&stMsg, 0, sizeof(stMsg));
+            stMsg.msg_iov = tIov;
+            stMsg.msg_iovlen = 2;
+            // a longer datagram is truncated, a shorter one fills less: only
+            // the payload received is reported
+            int iRead = recvmsg(iSocket, &stMsg, MSG_DONTWAIT);
+            uint32_t u32Got = (iRead > (int)stPacket.u16Header) ? (uint32_t)(iRead - stPacket.u16Header) : 0;
+            if (u32Got < stPacket.u16Length) {
+                stPacket.u16Length = (uint16_t)u32Got;
+                _stCounters.tu32Drops[DROP_MALFORMED]++;
+            }
+            else {
+                _stCounters.u32Packets++;
+            }
+            _bPending = true;
+            vAddRange(stPacket.u32Offset, stPacket.u16Length);
+            if (stPacket.bE131) {
+                _tu8Sequence[stPacket.u8Universe] = stPacket.u8Sequence;
+                _u32SeqValid |= u32Bit;
+                _u32Universes |= u32Bit;
+                _u16Sync = stPacket.u16Sync;
+                uint32_t u32All = (_u8NbUniverses < 32) ? (((uint32_t)1 << _u8NbUniverses) - 1) : 0xFFFFFFFFUL;
+                if (!_u16Sync && (_u32Universes == u32All)) {
+                    vNewFrame();
+                    eEvent = EVENT_FRAME;
+                }
+            }
+            else {
+                _u32Watermark = stPacket.u32Offset + stPacket.u16Length;
+                if (stPacket.bPush) {
+                    vNewFrame();
+                    eEvent = EVENT_FRAME;
+                }
+            }
+        }
+    }
+    return eEvent;
+}
+
+/*******************************************************************************
+ * @brief Drop the packets waiting, the output cannot be handed over
+ ******************************************************************************/
+void Realtime::vDiscard(void) {
+    int iSocket;
+    while ((iSocket = iReadable(0)) >= 0) {
+        vConsume(iSocket);
+        _stCounters.tu32Drops[DROP_BUSY]++;
+    }
+}
+
+/*******************************************************************************
+ * @brief Check that the owning source is still sending
+ * @param u32Now current time in milliseconds
+ * @return false once it stayed silent for the timeout
+ ******************************************************************************/
+bool Realtime::bIsActive(uint32_t u32Now) {
+    if (_bOwned && ((u32Now - _u32OwnerLast) > _u16TimeoutMs)) {
+        vRelease();
+        _stCounters.u32Timeouts++;
+    }
+    return _bOwned;
+}
+
+/*******************************************************************************
+ * @brief Forget the owning source and the frame in progress
+ ******************************************************************************/
+void Realtime::vRelease(void) {
+    _bOwned = false;
+    _u32OwnerAddr = 0;
+    _u8OwnerPriority = 0;
+    _u32OwnerLast = 0;
+    _u32SeqValid = 0;
+    _bPending = false;
+    _u32Universes = 0;
+    _u32Watermark = 0;
+    _u16Sync = 0;
+    _u8NbRanges = 0;
+    _u8FrameRanges = 0;
+}
+
+/*******************************************************************************
+ * @brief Byte ranges written into the last completed frame
+ * @details Valid after EVENT_FRAME until the next eReceive(). The bytes
+ *          outside of them were not written for this frame.
+ * @param ppstRanges set to the ranges, sorted by offset, not touching
+ * @return number of ranges
+ ******************************************************************************/
+uint8_t Realtime::u8GetFrameRanges(const TstRange **ppstRanges) const {
+    *ppstRanges = _tstRanges;
+    return _u8FrameRanges;
+}
+
+const char *Realtime::pcGetDropName(TeDrop eDrop) {
+    return (eDrop < NB_DROPS) ? CtcRealtime_Drops[eDrop] : "?";
+}
+
+/******************************************************************************/
+/* Private methods                                                            */
+/******************************************************************************/
+
+/*******************************************************************************
+ * @brief Wait for a readable socket
+ * @param u32WaitMs longest wait, 0: no wait
+ * @return socket, -1 if none
+ ******************************************************************************/
+int Realtime::iReadable(uint32_t u32WaitMs) {
+    fd_set xRead;
+    struct timeval stWait;
+    int iMax = (_iDdpSocket > _iE131Socket) ? _iDdpSocket : _iE131Socket;
+    int iSocket = -1;
+    if (iMax < 0)
+    { return -1; }
+    FD_ZERO(&xRead);
+    if (_iDdpSocket >= 0)
+    { FD_SET(_iDdpSocket, &xRead); }
+    if (_iE131Socket >= 0)
+    { FD_SET(_iE131Socket, &xRead); }
+    stWait.tv_sec = u32WaitMs / 1000;
+    stWait.tv_usec = (u32WaitMs % 1000) * 1000;
+    if (select(iMax + 1, &xRead, nullptr, nullptr, &stWait) > 0) {
+        bool bDdp = (_iDdpSocket >= 0) && FD_ISSET(_iDdpSocket, &xRead);
+        bool bE131 = (_iE131Socket >= 0) && FD_ISSET(_iE131Socket, &xRead);
+        _bPreferE131 = (bDdp && bE131) ? !_bPreferE131 : bE131;
+        iSocket = _bPreferE131 ? _iE131Socket : _iDdpSocket;
+    }
+    return iSocket;
+}
+
+/*******************************************************************************
+ * @brief Peek the header of the next packet and check it, nothing consumed
+ * @return NB_DROPS if the packet is to be handled, else why to drop it
+ ******************************************************************************/
+Realtime::TeDrop Realtime::eInspect(int iSocket, uint32_t u32Now, TstPacket *pstPacket) {
+    struct sockaddr_in stFrom;
+    socklen_t xFromLen = sizeof(stFrom);
+    memset(pstPacket, 0, sizeof(TstPacket));
+    memset(&stFrom, 0, sizeof(stFrom));
+    int iLength = recvfrom(iSocket, _tu8Header, sizeof(_tu8Header), MSG_PEEK | MSG_DONTWAIT, (struct sockaddr *)&stFrom, &xFromLen);
+    TeDrop eDrop = (iSocket == _iE131Socket) ? eParseE131(iLength, pstPacket) : eParseDdp(iLength, pstPacket);
+    if (eDrop == NB_DROPS)
+    { eDrop = eCheckSource(stFrom.sin_addr.s_addr, pstPacket, u32Now); }
+    return eDrop;
+}
+
+/*******************************************************************************
+ * @brief Decode a DDP header: RGB 8 bit data for the display
+ ******************************************************************************/
+Realtime::TeDrop Realtime::eParseDdp(int iLength, TstPacket *pstPacket) {
+    const uint8_t *pu8 = _tu8Header;
+    if ((iLength < _DDP_HEADER) || ((pu8[0] & _DDP_VERSION_MASK) != _DDP_VERSION_1))
+    { return DROP_MALFORMED; }
+    pstPacket->u16Header = (pu8[0] & _DDP_FLAG_TIMECODE) ? _DDP_HEADER_TIMECODE : _DDP_HEADER;
+    if (iLength < pstPacket->u16Header)
+    { return DROP_MALFORMED; }
+    // data type: custom bit, 3 bits of type (0 undefined, 1 RGB), 3 bits of size (0 undefined, 3: 8 bit)
+    uint8_t u8Type = pu8[2];
+    bool bRgb8 = !(u8Type & 0x80) && (((u8Type >> 3) & 0x07) <= 1) && (((u8Type & 0x07) == 0) || ((u8Type & 0x07) == 3));
+    if ((pu8[0] & (_DDP_FLAG_STORAGE | _DDP_FLAG_REPLY | _DDP_FLAG_QUERY)) || !bRgb8 ||
+        ((pu8[3] != _DDP_ID_DISPLAY) && (pu8[3] != _DDP_ID_ALL)))
+    { return DROP_UNSUPPORTED; }
+    pstPacket->u32Offset = u32Be(pu8 + 4);
+    if (pstPacket->u32Offset >= _u32FrameBytes)
+    { return DROP_RANGE; }
+    uint32_t u32Room = _u32FrameBytes - pstPacket->u32Offset;
+    uint16_t u16Length = u16Be(pu8 + 8);
+    pstPacket->u16Length = (u16Length < u32Room) ? u16Length : (uint16_t)u32Room;
+    pstPacket->u8Priority = _DDP_PRIORITY;
+    pstPacket->bPush = (pu8[0] & _DDP_FLAG_PUSH) != 0;
+    return NB_DROPS;
+}
+
+/*******************************************************************************
+ * @brief Decode an E1.31 header: DMX data of a universe of the frame, or sync
+ ******************************************************************************/
+Realtime::TeDrop Realtime::eParseE131(int iLength, TstPacket *pstPacket) {
+    const uint8_t *pu8 = _tu8Header;
+    if ((iLength < _E131_ROOT_LEN) || (u16Be(pu8) != 0x0010) || (u16Be(pu8 + 2) != 0) ||
+        memcmp(pu8 + 4, Ctu8Realtime_AcnId, sizeof(Ctu8Realtime_AcnId)))
+    { return DROP_MALFORMED; }
+    pstPacket->bE131 = true;
+    uint32_t u32Root = u32Be(pu8 + 18);
+    if (u32Root == _E131_ROOT_EXTENDED) {
+        if (iLength < _E131_SYNC_LEN)
+        { return DROP_MALFORMED; }
+        if (u32Be(pu8 + 40) != _E131_FRAMING_SYNC)
+        { return DROP_UNSUPPORTED; } // universe discovery
+        pstPacket->bSync = true;
+        pstPacket->u8Sequence = pu8[44];
+        pstPacket->u16Sync = u16Be(pu8 + 45);
+        pstPacket->u16Header = _E131_SYNC_LEN;
+        return NB_DROPS;
+    }
+    if (u32Root != _E131_ROOT_DATA)
+    { return DROP_UNSUPPORTED; }
+    if ((iLength < _E131_DATA_HEADER) || (u32Be(pu8 + 40) != _E131_FRAMING_DATA) ||
+        (pu8[117] != _E131_DMP_SET_PROPERTY) || (pu8[118] != _E131_DMP_ADDRESS_TYPE))
+    { return DROP_MALFORMED; }
+    uint8_t u8Options = pu8[112];
+    if (u8Options & _E131_OPT_PREVIEW)
+    { return DROP_PREVIEW; }
+    uint16_t u16Universe = u16Be(pu8 + 113);
+    if ((u16Universe < _u16Universe) || ((u16Universe - _u16Universe) >= _u8NbUniverses))
+    { return DROP_RANGE; }
+    uint16_t u16Count = u16Be(pu8 + 123); // start code included
+    if (!u16Count || (u16Count > (_E131_MAX_CHANNELS + 1)))
+    { return DROP_MALFORMED; }
+    if (pu8[125] != 0)
+    { return DROP_UNSUPPORTED; } // not dimmer data
+    pstPacket->u8Universe = (uint8_t)(u16Universe - _u16Universe);
+    pstPacket->u32Offset = (uint32_t)pstPacket->u8Universe * REALTIME_UNIVERSE_BYTES;
+    if (pstPacket->u32Offset >= _u32FrameBytes)
+    { return DROP_RANGE; }
+    uint32_t u32Room = _u32FrameBytes - pstPacket->u32Offset;
+    uint16_t u16Length = ((u16Count - 1) < REALTIME_UNIVERSE_BYTES) ? (u16Count - 1) : REALTIME_UNIVERSE_BYTES;
+    pstPacket->u16Length = (u16Length < u32Room) ? u16Length : (uint16_t)u32Room;
+    pstPacket->u16Header = _E131_DATA_HEADER;
+    pstPacket->u8Priority = pu8[108];
+    pstPacket->u16Sync = u16Be(pu8 + 109);
+    pstPacket->u8Sequence = pu8[111];
+    pstPacket->bTerminated = (u8Options & _E131_OPT_TERMINATED) != 0;
+    return NB_DROPS;
+}
+
+/*******************************************************************************
+ * @brief Check the source of a packet against the owner of the output
+ * @details A silent owner is lost; a source of a higher priority takes the
+ *          output over. Sync packets only count from the owner. Sequences
+ *          are only checked here, recorded when the payload is read.
+ ******************************************************************************/
+Realtime::TeDrop Realtime::eCheckSource(uint32_t u32Addr, const TstPacket *pstPacket, uint32_t u32Now) {
+    bIsActive(u32Now);
+    bool bOwner = _bOwned && (u32Addr == _u32OwnerAddr);
+    if (pstPacket->bSync)
+    { return bOwner ? NB_DROPS : DROP_PRIORITY; }
+    if (!bOwner) {
+        if (_bOwned && (pstPacket->u8Priority <= _u8OwnerPriority))
+        { return DROP_PRIORITY; }
+        vRelease();
+        _bOwned = true;
+        _u32OwnerAddr = u32Addr;
+    }
+    _u8OwnerPriority = pstPacket->u8Priority;
+    _u32OwnerLast = u32Now;
+    if (pstPacket->bE131 && (_u32SeqValid & ((uint32_t)1 << pstPacket->u8Universe))) {
+        int8_t i8Diff = (int8_t)(pstPacket->u8Sequence - _tu8Sequence[pstPacket->u8Universe]);
+        if ((i8Diff <= 0) && (i8Diff > _E131_SEQ_WINDOW))
+        { return DROP_SEQUENCE; }
+    }
+    return NB_DROPS;
+}
+
+/*******************************************************************************
+ * @brief Read and forget the next packet of a socket
+ ******************************************************************************/
+void Realtime::vConsume(int iSocket) {
+    recv(iSocket, _tu8Header, 1, MSG_DONTWAIT); // the rest of the datagram is discarded
+}
+
+/*******************************************************************************
+ * @brief Record a payload into the written ranges of the frame in progress
+ * @details Kept sorted, a range touching a neighbour is merged with it. The
+ *          caller makes sure one is free: a payload never overlaps another
+ *          one of the same frame.
+ ******************************************************************************/
+void Realtime::vAddRange(uint32_t u32Offset, uint32_t u32Length) {
+    uint8_t u8Pos = 0;
+    if (!u32Length)
+    { return; }
+    while ((u8Pos < _u8NbRanges) && (_tstRanges[u8Pos].u32Offset < u32Offset))
+    { u8Pos++; }
+    TstRange *pstPrev = u8Pos ? &_tstRanges[u8Pos - 1] : nullptr;
+    TstRange *pstNext = (u8Pos < _u8NbRanges) ? &_tstRanges[u8Pos] : nullptr;
+    bool bPrev = pstPrev && ((pstPrev->u32Offset + pstPrev->u32Length) == u32Offset);
+    bool bNext = pstNext && ((u32Offset + u32Length) == pstNext->u32Offset);
+    if (bPrev && bNext) {
+        pstPrev->u32Length += u32Length + pstNext->u32Length;
+        memmove(pstNext, pstNext + 1, (_u8NbRanges - u8Pos - 1) * sizeof(TstRange));
+        _u8NbRanges--;
+    }
+    else if (bPrev) {
+        pstPrev->u32Length += u32Length;
+    }
+    else if (bNext) {
+        pstNext->u32Offset = u32Offset;
+        pstNext->u32Length += u32Length;
+    }
+    else {
+        memmove(&_tstRanges[u8Pos + 1], &_tstRanges[u8Pos], (_u8NbRanges - u8Pos) * sizeof(TstRange));
+        _tstRanges[u8Pos].u32Offset = u32Offset;
+        _tstRanges[u8Pos].u32Length = u32Length;
+        _u8NbRanges++;
+    }
+}
+
+/*******************************************************************************
+ * @brief Frame shown, the next payloads start a new one
+ ******************************************************************************/
+void Realtime::vNewFrame(void) {
+    _stCounters.u32Frames++;
+    _bPending = false;
+    _u32Universes = 0;
+    _u32Watermark = 0;
+    _u16Sync = 0;
+    _u8FrameRanges = _u8NbRanges;
+    _u8NbRanges = 0;
+}
+
+/*******************************************************************************
+ * @brief Bind a UDP socket on any address
+ * @return socket, -1 on error
+ ******************************************************************************/
+int Realtime::iOpenSocket(uint16_t u16Port) {
+    int iSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (iSocket >= 0) {
+        int iOn = 1;
+        struct sockaddr_in stAddr;
+        memset(&stAddr, 0, sizeof(stAddr));
+        stAddr.sin_family = AF_INET;
+        stAddr.sin_port = htons(u16Port);
+        stAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+        setsockopt(iSocket, SOL_SOCKET, SO_REUSEADDR, &iOn, sizeof(iOn));
+        if (bind(iSocket, (struct sockaddr *)&stAddr, sizeof(stAddr)) < 0) {
+            close(iSocket);
+            iSocket = -1;
+        }
+    }
+    return iSocket;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file Realtime.h
+ * @brief Header file for the Realtime class.
+ * @author Nello
+ * @date 2026-01-12
+ */
+
+#ifndef _REALTIME_H
+#define _REALTIME_H
+
+#include <stdint.h>
+
+#define REALTIME_DDP_PORT       4048
+#define REALTIME_E131_PORT      5568
+#define REALTIME_TIMEOUT_MS     2500 // E1.31 network data loss
+#define REALTIME_MAX_UNIVERSES  32 // E1.31 universes of a frame
+#define REALTIME_UNIVERSE_BYTES 510 // 170 RGB pixels per universe
+#define REALTIME_HEADER_MAX     126 // E1.31 data packet header, start code included
+#define REALTIME_MAX_RANGES     REALTIME_MAX_UNIVERSES // written byte ranges of a frame
+
+/*
+ * Reasons a packet is dropped:
+ *  - malformed: truncated or inconsistent header, or payload shorter than
+ *    announced; what was received of it is still kept
+ *  - unsupported: valid but unhandled (DDP query, RGBW, E1.31 discovery...)
+ *  - range: universe or offset outside of the ledstrip
+ *  - sequence: E1.31 packet older than the last one of its universe
+ *  - priority: another source owns the output
+ *  - preview: E1.31 preview data, not for live output
+ *  - busy: received while the LEDs are off or in standby
+ */
+#define FOREACH_REALTIME_DROP(DROP)         \
+    DROP(DROP_MALFORMED,    malformed)      \
+    DROP(DROP_UNSUPPORTED,  unsupported)    \
+    DROP(DROP_RANGE,        range)          \
+    DROP(DROP_SEQUENCE,     sequence)       \
+    DROP(DROP_PRIORITY,     priority)       \
+    DROP(DROP_PREVIEW,      preview)        \
+    DROP(DROP_BUSY,         busy)
+
+#define GENERATE_REALTIME_ENUM(ENUM, NAME)  ENUM,
+
+/*
+ * Realtime pixel input over UDP, DDP and E1.31 (sACN), from a lighting desk
+ * or a media server. The header of a packet is peeked first, then a single
+ * scatter read puts the payload straight at its place in the caller's frame:
+ * no intermediate copy. E1.31 universes follow each other from the first
+ * one, REALTIME_UNIVERSE_BYTES each, DDP offsets are frame bytes. A frame
+ * completes on a DDP push, on an E1.31 sync packet, once every universe
+ * arrived (without sync), or when a packet would overwrite the frame in
+ * progress; that packet stays queued for the next frame. The byte ranges a
+ * frame got are reported: the rest of the buffer was not written.
+ * The first source of the highest priority owns the output (no merge) until
+ * it terminates its stream or stays silent for the timeout. Plain BSD
+ * sockets: the class also builds on a host, for loopback tests.
+ */
+class Realtime {
+public:
+    typedef enum {
+        RET_OK                  = 0,
+        RET_GENERIC_ERROR       = -1,
+        RET_BAD_PARAMETER       = RET_GENERIC_ERROR - 1,
+    } TeRetVal;
+
+    typedef enum {
+        EVENT_NONE, // nothing received in time
+        EVENT_PACKET, // one packet handled, written or dropped
+        EVENT_FRAME, // frame complete, to be shown before the next call
+    } TeEvent;
+
+    typedef enum {
+        FOREACH_REALTIME_DROP(GENERATE_REALTIME_ENUM)
+        NB_DROPS
+    } TeDrop;
+
+    typedef struct {
+        uint32_t u32Packets; // payloads written
+        uint32_t u32Frames; // frames completed
+        uint32_t u32Syncs; // E1.31 sync packets of the owning source
+        uint32_t u32Timeouts; // owning source lost on silence
+        uint32_t tu32Drops[NB_DROPS];
+    } TstCounters;
+
+    typedef struct {
+        uint32_t u32Offset; // first frame byte
+        uint32_t u32Length;
+    } TstRange;
+
+    Realtime();
+    ~Realtime();
+    TeRetVal eConfigure(uint16_t u16DdpPort, uint16_t u16E131Port, uint16_t u16Universe, uint32_t u32FrameBytes);
+    TeRetVal eSetTimeout(uint16_t u16TimeoutMs);
+    TeRetVal eOpen(void);
+    void vClose(void);
+    bool bPoll(uint32_t u32Now, uint32_t u32WaitMs);
+    TeEvent eReceive(uint8_t *pu8Frame, uint32_t u32Now, uint32_t u32WaitMs);
+    void vDiscard(void);
+    bool bIsActive(uint32_t u32Now);
+    void vRelease(void);
+
+    uint8_t u8GetFrameRanges(const TstRange **ppstRanges) const;
+    const TstCounters &stGetCounters(void) const { return _stCounters; }
+    static const char *pcGetDropName(TeDrop eDrop);
+
+private:
+    typedef struct {
+        uint32_t u32Offset; // first frame byte
+        uint16_t u16Length; // payload bytes kept, clamped to the frame
+        uint16_t u16Header; // bytes before the payload
+        uint16_t u16Sync; // E1.31 sync address, 0: none
+        uint8_t u8Universe; // E1.31 index from the first universe
+        uint8_t u8Priority;
+        uint8_t u8Sequence;
+        bool bE131;
+        bool bPush; // DDP frame complete after this payload
+        bool bSync; // E1.31 sync packet, no payload
+        bool bTerminated; // E1.31 source leaves
+    } TstPacket;
+
+    int _iDdpSocket; // -1: closed
+    int _iE131Socket;
+    bool _bPreferE131; // both readable: take turns
+    uint16_t _u16DdpPort; // 0: disabled
+    uint16_t _u16E131Port;
+    uint16_t _u16Universe; // first E1.31 universe
+    uint8_t _u8NbUniverses;
+    uint32_t _u32FrameBytes;
+    uint16_t _u16TimeoutMs;
+
+    bool _bOwned; // a source owns the output
+    uint32_t _u32OwnerAddr; // IPv4, network order
+    uint8_t _u8OwnerPriority;
+    uint32_t _u32OwnerLast; // ms, last packet of the owner
+
+    bool _bPending; // payload written since the last frame
+    uint32_t _u32Universes; // E1.31 universes written into the frame
+    uint32_t _u32Watermark; // DDP end of the last write
+    uint16_t _u16Sync; // E1.31 sync address the frame waits for, 0: none
+    uint32_t _u32SeqValid; // universes with a known sequence
+    uint8_t _tu8Sequence[REALTIME_MAX_UNIVERSES];
+    TstRange _tstRanges[REALTIME_MAX_RANGES]; // written, sorted, merged when they touch
+    uint8_t _u8NbRanges; // of the frame in progress
+    uint8_t _u8FrameRanges; // of the last completed frame
+
+    uint8_t _tu8Header[REALTIME_HEADER_MAX];
+    TstCounters _stCounters;
+
+    int iReadable(uint32_t u32WaitMs);
+    TeDrop eInspect(int iSocket, uint32_t u32Now, TstPacket *pstPacket);
+    TeDrop eParseDdp(int iLength, TstPacket *pstPacket);
+    TeDrop eParseE131(int iLength, TstPacket *pstPacket);
+    TeDrop eCheckSource(uint32_t u32Addr, const TstPacket *pstPacket, uint32_t u32Now);
+    void vConsume(int iSocket);
+    void vAddRange(uint32_t u32Offset, uint32_t u32Length);
+    void vNewFrame(void);
+    static int iOpenSocket(uint16_t u16Port);
+};
+
+#endif // _REALTIME_H
@@ -6,12 +6,21 @@
  */
 
 #include "SubStrip.h"
+#include "Kernels.h"
 
-#define SUBSTRIP_STOP_PERIODIC     (uint32_t)(-1)
-#define SUBSTRIP_SECURE_LOOOP      30
 #define _SUBSTRIP_PERIOD           (1000/SUBSTRIP_FPS)
+#define _SUBSTRIP_MAX_ELAPSED      1000 // ms, longer stalls are not caught up
+#define _SUBSTRIP_XFADE_END        ((uint32_t)255 << 16) // Q16, new animation alone
+#define _PHASE_ONE                 ((uint32_t)1 << 16) // Q16 phase accumulators
 
 #define _MNG_RETURN(x)  eRet = x
+#define GENERATE_BLEND_STR(ENUM, NAME)  #NAME,
+
+static const char *tcSubStripBlends[SubStrip::NB_BLENDS] = {
+    FOREACH_SUBSTRIP_BLEND(GENERATE_BLEND_STR)
+};
+
+static inline CRGB xBlendPixel(CRGB xBelow, const CRGB &xLayer, SubStrip::TeBlend eBlend, uint8_t u8Alpha);
 
 /******************************************************************************/
 /* Public methods                                                             */
@@ -19,34 +28,50 @@
 
 /*******************************************************************************
  * @brief Constructor for the SubStrip class.
- * @param u8NbLeds Number of LEDs in the sub-strip.
+ * @param u16NbLeds Number of LEDs in the sub-strip.
  ******************************************************************************/
-SubStrip::SubStrip(uint8_t u8NbLeds, CRGB *pLeds) {
-    u8NbLeds = (u8NbLeds < 1) ? 1 : u8NbLeds; // Ensure at least one LED
-    u8NbLeds = (u8NbLeds > 200) ? 200 : u8NbLeds; // Ensure at most 200 LEDs
-    _u8NbLeds = u8NbLeds;
-    _ColorPalette = nullptr;
+SubStrip::SubStrip(uint16_t u16NbLeds, CRGB *pLeds) {
+    u16NbLeds = (u16NbLeds < 1) ? 1 : u16NbLeds; // Ensure at least one LED
+    u16NbLeds = (u16NbLeds > SUBSTRIP_MAX_LEDS) ? SUBSTRIP_MAX_LEDS : u16NbLeds;
+    _u16NbLeds = u16NbLeds;
+    _pPalette = nullptr;
+    _u8PaletteRev = 0;
     if (pLeds != nullptr) { // dynamic allocation
         _SubLeds = pLeds; // use given pointer as strip reference
         _bDynamic = false;
     }
     else {
-        _SubLeds = new CRGB[_u8NbLeds];
+        _SubLeds = new CRGB[_u16NbLeds];
         _bDynamic = true;
     }
     
     _u32Period = 2000;
-    _u32Timeout = 0;
     _bTrigger = false;
     _u8Speed = 1;
-    _u8FadeRate = u8FadeTimeToRate(500);
+    _u32StepInc = u32PeriodToInc(_SUBSTRIP_PERIOD);
+    _u32FadeInc = u32FadeTimeToInc(500);
+    _u32StepPhase = 0;
+    _u32FadePhase = 0;
+    _u32LastTick = 0;
+    _u32Deadline = 0;
+    _u16FramePeriod = _SUBSTRIP_PERIOD;
+    _bClockSync = false;
 
     /* Init animation parameters */
-    _u8Index = 0;
     _u8Bpm = 30;
-    _u8DelayRate = 0;
-    _pPixel = nullptr;
-    _u8Offset = 0;
+    _u8Width = 6;
+    _u16Offset = 0;
+    memset(_tLayers, 0, sizeof(_tLayers));
+    _pLayerPool = nullptr;
+    _u8NbActiveLayers = 0;
+    _pu16Active = nullptr;
+    _u16NbActive = SUBSTRIP_ACTIVE_STALE;
+    _pParticles = nullptr;
+    _u8NbParticles = 0;
+    _pTransition = nullptr;
+    _u32XfadeInc = 0;
+    _u32XfadePhase = 0;
+    _u32Rng = (uint32_t)(uintptr_t)_SubLeds | 1; // distinct per sub-strip until seeded, the object may be a copied temporary
     vClear();
 }
 
@@ -62,19 +87,63 @@ SubStrip::~SubStrip() {
 
 /*******************************************************************************
  * @brief Copies the sub-strip LED content to the provided LED array.
+ * @details The rotation head (_u16Offset) is applied here as a modular offset,
+ *          so a rotating animation never moves pixels inside the sub-strip.
  * @param leds Pointer to the destination LED array.
- * @param u8NbLeds Number of LEDs to copy.
+ * @param u16NbLeds Number of LEDs to copy.
+ * @param pLut output stage applied on the copy, nullptr for raw pixels
  ******************************************************************************/
-SubStrip::TeRetVal SubStrip::eGetSubStrip(CRGB *leds, uint8_t u8NbLeds) {
+SubStrip::TeRetVal SubStrip::eGetSubStrip(CRGB *leds, uint16_t u16NbLeds, const OutputLut *pLut) {
     TeRetVal eRet = RET_OK;
-    if ((u8NbLeds > _u8NbLeds) || (leds == nullptr))
+    if ((u16NbLeds > _u16NbLeds) || (leds == nullptr))
     { _MNG_RETURN(RET_BAD_PARAMETER); }
-    else if (!_bDynamic)
-    { _MNG_RETURN(RET_INTERNAL_ERROR); }
     else if (_SubLeds == nullptr)
     { _MNG_RETURN(RET_INTERNAL_ERROR); }
+    else if (!_u8NbActiveLayers && !_u32XfadeInc && (pLut != nullptr)) {
+        // output stage fused in the copy: each pixel is read and written once
+        uint16_t u16Idx = u16GetRotation();
+        u16Idx = u16Idx ? (_u16NbLeds - u16Idx) : 0;
+        for (uint16_t i = 0; i < u16NbLeds; i++) {
+            leds[i] = pLut->xApply(_SubLeds[u16Idx]);
+            u16Idx = (u16Idx + 1 < _u16NbLeds) ? (u16Idx + 1) : 0;
+        }
+    }
+    else if (!_u8NbActiveLayers && !_u32XfadeInc) {
+        uint16_t u16Head = u16GetRotation();
+        uint16_t u16Wrap = (u16Head < u16NbLeds) ? u16Head : u16NbLeds;
+        // displayed[i] = base[(i - head) mod n]
+        memcpy(leds, _SubLeds + _u16NbLeds - u16Head, u16Wrap * sizeof(CRGB));
+        memcpy(leds + u16Wrap, _SubLeds, (u16NbLeds - u16Wrap) * sizeof(CRGB));
+    }
     else {
-        memcpy(leds, _SubLeds, u8NbLeds * sizeof(CRGB));
+        // single pass: each output pixel folds the base crossfaded from the
+        // former one, then the overlay layers
+        TstLayer *tpLayers[SUBSTRIP_MAX_LAYERS - 1];
+        uint8_t u8Xfade = _u32XfadePhase >> 16;
+        uint16_t tu16Idx[SUBSTRIP_MAX_LAYERS - 1];
+        uint8_t u8NbLayers = 0;
+        uint16_t u16Head = u16GetRotation();
+        uint16_t u16Idx = u16Head ? (_u16NbLeds - u16Head) : 0;
+        for (uint8_t k = 0; k < (SUBSTRIP_MAX_LAYERS - 1); k++) {
+            TstLayer *pLayer = &_tLayers[k];
+            if (pLayer->eAnim != NONE) {
+                uint16_t u16LayerHead = tSubStripFx[pLayer->eAnim].bRotate ? pLayer->u16Offset : 0;
+                tu16Idx[u8NbLayers] = u16LayerHead ? (_u16NbLeds - u16LayerHead) : 0;
+                tpLayers[u8NbLayers++] = pLayer;
+            }
+        }
+        for (uint16_t i = 0; i < u16NbLeds; i++) {
+            CRGB xPixel = _SubLeds[u16Idx];
+            u16Idx = (u16Idx + 1 < _u16NbLeds) ? (u16Idx + 1) : 0;
+            if (_u32XfadeInc)
+            { xPixel = xKernel_BlendPixel(_pTransition[i], xPixel, u8Xfade); }
+            for (uint8_t k = 0; k < u8NbLayers; k++) {
+                TstLayer *pLayer = tpLayers[k];
+                xPixel = xBlendPixel(xPixel, pLayer->pLeds[tu16Idx[k]], pLayer->eBlend, pLayer->u8Alpha);
+                tu16Idx[k] = (tu16Idx[k] + 1 < _u16NbLeds) ? (tu16Idx[k] + 1) : 0;
+            }
+            leds[i] = (pLut != nullptr) ? pLut->xApply(xPixel) : xPixel;
+        }
     }
     return eRet;
 }
@@ -82,56 +151,95 @@ SubStrip::TeRetVal SubStrip::eGetSubStrip(CRGB *leds, uint8_t u8NbLeds) {
 /*******************************************************************************
  * @brief Sets the sub-strip LED content from the provided LED array.
  * @param leds Pointer to the source LED array.
- * @param u8NbLeds Number of LEDs to set.
+ * @param u16NbLeds Number of LEDs to set.
  ******************************************************************************/
-SubStrip::TeRetVal SubStrip::eSetSubStrip(CRGB *leds, uint8_t u8NbLeds) {
+SubStrip::TeRetVal SubStrip::eSetSubStrip(CRGB *leds, uint16_t u16NbLeds) {
     TeRetVal eRet = RET_OK;
-    if ((leds == nullptr) || (u8NbLeds > _u8NbLeds)) {
+    if ((leds == nullptr) || (u16NbLeds > _u16NbLeds)) {
         _MNG_RETURN(RET_BAD_PARAMETER);
     }
     else {
-        memcpy(_SubLeds, leds, u8NbLeds * sizeof(CRGB));
+        uint16_t u16Head = u16GetRotation();
+        uint16_t u16Wrap = (u16Head < u16NbLeds) ? u16Head : u16NbLeds;
+        memcpy(_SubLeds + _u16NbLeds - u16Head, leds, u16Wrap * sizeof(CRGB));
+        memcpy(_SubLeds, leds + u16Wrap, (u16NbLeds - u16Wrap) * sizeof(CRGB));
+        _u16NbActive = SUBSTRIP_ACTIVE_STALE;
+        _bDirty = true;
     }
     return eRet;
 }
 
 /*******************************************************************************
  * @brief Manage animations within the sub-strip.
+ * @details Animations advance with the time elapsed since the previous call,
+ *          not with the number of calls: the call rate may vary or drop.
+ * @param u32Now current time in milliseconds
  ******************************************************************************/
 void SubStrip::vManageAnimation(uint32_t u32Now)
 {
+    uint32_t u32Elapsed = _bClockSync ? (u32Now - _u32LastTick) : 0;
+    _u32LastTick = u32Now;
+    _bClockSync = true;
+    // keep the frame grid, unless late by more than a frame
+    _u32Deadline += _u16FramePeriod;
+    if ((int32_t)(_u32Deadline - u32Now) <= 0)
+    { _u32Deadline = u32Now + _u16FramePeriod; }
+    if (u32Elapsed > _SUBSTRIP_MAX_ELAPSED)
+    { u32Elapsed = _SUBSTRIP_MAX_ELAPSED; }
+
     if (_SubLeds != nullptr)
     {
-        switch (_eCurrentAnimation)
-        {
-        case GLITTER:
-            // Call glitter animation function
-            vAnimateGlitter();
-            break;
-
-        case RAINDROPS:
-            // Call raindrops animation function
-            if ((_u32Timeout < u32Now) && (_u32Period != SUBSTRIP_STOP_PERIODIC))
-            {
-                _u32Timeout = u32Now + _u32Period;
-                _bTrigger = true;
+        // palette edited in place: palette dependent effects render again
+        if ((_pPalette != nullptr) && (_u8PaletteRev != _pPalette->u8GetRevision())) {
+            _u8PaletteRev = _pPalette->u8GetRevision();
+            eInitFx();
+        }
+        TstTick stTick;
+        stTick.u32Now = u32Now;
+        stTick.u16Steps = u16AdvanceSteps(u32Elapsed);
+        stTick.u8Fade = u8AdvanceFade(u32Elapsed);
+        // dispatch through the registry table, no branch per effect
+        tSubStripFx[_eCurrentAnimation].pfStep(*this, _tu32FxState, stTick);
+        for (uint8_t k = 0; _u8NbActiveLayers && (k < (SUBSTRIP_MAX_LAYERS - 1)); k++) {
+            TstLayer &rLayer = _tLayers[k];
+            if (rLayer.eAnim != NONE) {
+                vSwapLayer(rLayer);
+                tSubStripFx[_eCurrentAnimation].pfStep(*this, rLayer.tu32FxState, stTick);
+                vSwapLayer(rLayer);
             }
-            vAnimateRaindrops();
-            break;
+        }
+        if (_u32XfadeInc) {
+            uint64_t u64Phase = _u32XfadePhase + ((uint64_t)u32Elapsed * _u32XfadeInc);
+            _u32XfadePhase = (u64Phase < _SUBSTRIP_XFADE_END) ? (uint32_t)u64Phase : _SUBSTRIP_XFADE_END;
+            _u32XfadeInc = (_u32XfadePhase < _SUBSTRIP_XFADE_END) ? _u32XfadeInc : 0;
+            _bDirty = true; // the mix changes every frame
+        }
+    }
+}
 
-        case CHECKERED:
-            // Call checkered animation function
-            vAnimateCheckered();
-            break;
+/*******************************************************************************
+ * @brief Check if the sub-strip has to be animated
+ * @param u32Now current time in milliseconds
+ * @return true once the frame deadline is reached
+ ******************************************************************************/
+bool SubStrip::bIsDue(uint32_t u32Now) {
+    return !_bClockSync || ((int32_t)(u32Now - _u32Deadline) >= 0);
+}
 
-        case WAVE:
-            vAnimateWave();
-            break;
+/*******************************************************************************
+ * @brief Get the time of the next frame
+ * @return deadline in milliseconds
+ ******************************************************************************/
+uint32_t SubStrip::u32GetDeadline(void) {
+    return _u32Deadline;
+}
 
-        default:
-            break;
-        }
-    }
+/*******************************************************************************
+ * @brief Frame period, from the target frame rate
+ * @return period in milliseconds
+ ******************************************************************************/
+uint16_t SubStrip::u16GetFramePeriod(void) {
+    return _u16FramePeriod;
 }
 
 /*******************************************************************************
@@ -143,22 +251,17 @@ SubStrip::SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim) {
         _MNG_RETURN(RET_BAD_PARAMETER);
     }
     else {
-        _u8DelayRate = 0;
-        _u8Index = 0;
-
-        switch(eAnim) {
-            case SubStrip::CHECKERED:
-                eRet = eInitCheckered();
-                break;
-            default:
-                break;
-        }
+        _u32StepPhase = 0;
+        _u32XfadeInc = 0; // a cut ends a crossfade
+        memset(_tu32FxState, 0, sizeof(_tu32FxState));
         _eCurrentAnimation = eAnim;
+        eRet = tSubStripFx[eAnim].pfInit(*this, _tu32FxState);
+        _bDirty = true; // rotation may have changed
     }
     return eRet;
 }
 
-SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim, CRGB *pPalette) {
+SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim, const Palette *pPalette) {
     TeRetVal eRet = eSetColorPalette(pPalette);
     if (eRet >= RET_OK) {
         eRet = eSetAnimation(eAnim);
@@ -166,7 +269,7 @@ SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim, CRGB *pPalette) {
     return eRet;
 }
 
-SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim, CRGB *pPalette, uint32_t u32Period) {
+SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim, const Palette *pPalette, uint32_t u32Period) {
     TeRetVal eRet = eSetColorPalette(pPalette);
     if (eRet >= RET_OK) {
         eRet = eSetAnimation(eAnim);
@@ -175,7 +278,7 @@ SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim, CRGB *pPalette, ui
     return eRet;
 }
 
-SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim, CRGB *pPalette, uint32_t u32Period, uint8_t u8Speed) {
+SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim, const Palette *pPalette, uint32_t u32Period, uint8_t u8Speed) {
     TeRetVal eRet = eSetColorPalette(pPalette);
     if (eRet >= RET_OK) {
         eRet = eSetAnimation(eAnim);
@@ -185,35 +288,249 @@ SubStrip::TeRetVal SubStrip::eSetAnimation(TeAnimation eAnim, CRGB *pPalette, ui
     return eRet;
 }
 
+/*******************************************************************************
+ * @brief Switch animation with a crossfade
+ * @details The base image shown now is copied into the transition buffer and
+ *          fades out while the new animation starts from black; the overlay
+ *          layers are composited over the mix. A crossfade started during
+ *          another one fades out their current mix. Without transition buffer
+ *          or duration, the animation is cut as eSetAnimation() does.
+ * @param eAnim new animation
+ * @param u16Ms crossfade duration
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eCrossfade(TeAnimation eAnim, uint16_t u16Ms) {
+    TeRetVal eRet = RET_OK;
+    if (eAnim >= SubStrip::NB_ANIMS) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else if ((_pTransition == nullptr) || !u16Ms) {
+        eRet = eSetAnimation(eAnim);
+    }
+    else {
+        // base only, rotation applied
+        uint8_t u8Xfade = _u32XfadePhase >> 16;
+        uint16_t u16Idx = u16GetRotation();
+        u16Idx = u16Idx ? (_u16NbLeds - u16Idx) : 0;
+        for (uint16_t i = 0; i < _u16NbLeds; i++) {
+            CRGB xPixel = _SubLeds[u16Idx];
+            u16Idx = (u16Idx + 1 < _u16NbLeds) ? (u16Idx + 1) : 0;
+            _pTransition[i] = _u32XfadeInc ? xKernel_BlendPixel(_pTransition[i], xPixel, u8Xfade) : xPixel;
+        }
+        vClear();
+        eRet = eSetAnimation(eAnim);
+        _u32XfadeInc = _SUBSTRIP_XFADE_END / u16Ms;
+        _u32XfadePhase = 0;
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Give the buffer a crossfade keeps the former image in
+ * @details Preallocated by the owner, a crossfade never allocates
+ * @param pBuffer number of LEDs pixels
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eSetTransitionBuffer(CRGB *pBuffer) {
+    TeRetVal eRet = RET_OK;
+    if (pBuffer == nullptr) {
+        _MNG_RETURN(RET_NULLPTR);
+    }
+    else {
+        _pTransition = pBuffer;
+    }
+    return eRet;
+}
+
 /*******************************************************************************
  * @brief Set color palette
  ******************************************************************************/
-SubStrip::TeRetVal SubStrip::eSetColorPalette(CRGB *ColorPalette) {
-TeRetVal eRet = RET_OK;
+SubStrip::TeRetVal SubStrip::eSetColorPalette(const Palette *pPalette) {
+    TeRetVal eRet = RET_OK;
     /* Protect from bad parameters */
-    if (ColorPalette == nullptr) {
+    if (pPalette == nullptr) {
         _MNG_RETURN(RET_BAD_PARAMETER);
     }
-    else if (*ColorPalette == CRGB::Black) {
+    else if (!pPalette->u8GetNbColors()) {
         _MNG_RETURN(RET_GENERIC_ERROR);
     }
     else {
-        CRGB *pColor = ColorPalette;
-
-        /* auto-detect nomber of colors */
-        _u8ColorNb = 0;
-        uint8_t u8SecureLoop = 0;
-        while (*pColor && (*pColor != CRGB::Black) && (u8SecureLoop < SUBSTRIP_SECURE_LOOOP)) {
-            _u8ColorNb++;
-            pColor++;
-            u8SecureLoop++;
+        _pPalette = pPalette;
+        _u8PaletteRev = pPalette->u8GetRevision();
+
+        // palette dependent effects render again
+        eRet = eInitFx();
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Give the buffer the overlay layers render into
+ * @details Preallocated by the owner, setting a layer never allocates.
+ *          Layers above u8NbLayers have no pixels and cannot be set.
+ * @param pPool u8NbLayers * number of LEDs pixels
+ * @param u8NbLayers overlay layers the pool holds, first ones
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eSetLayerPool(CRGB *pPool, uint8_t u8NbLayers) {
+    TeRetVal eRet = RET_OK;
+    if (pPool == nullptr) {
+        _MNG_RETURN(RET_NULLPTR);
+    }
+    else if (u8NbLayers > (SUBSTRIP_MAX_LAYERS - 1)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        _pLayerPool = pPool;
+        for (uint8_t k = 0; k < (SUBSTRIP_MAX_LAYERS - 1); k++) {
+            _tLayers[k].pLeds = (k < u8NbLayers) ? (_pLayerPool + k * _u16NbLeds) : nullptr;
         }
+    }
+    return eRet;
+}
 
-        if (_eCurrentAnimation == SubStrip::CHECKERED) {
-            eRet = eInitCheckered();
+/*******************************************************************************
+ * @brief Attach the active pixel lists: sparse effects then fade the lit
+ *        pixels only, instead of the whole sub-strip
+ * @param pPool (1 + u8NbLayers) * _u16NbLeds indexes, base list first
+ * @param u8NbLayers overlay layers with a list, the others are not tracked
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eSetActivePool(uint16_t *pPool, uint8_t u8NbLayers) {
+    TeRetVal eRet = RET_OK;
+    if (pPool == nullptr) {
+        _MNG_RETURN(RET_NULLPTR);
+    }
+    else if (u8NbLayers > (SUBSTRIP_MAX_LAYERS - 1)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        _pu16Active = pPool;
+        _u16NbActive = SUBSTRIP_ACTIVE_STALE;
+        for (uint8_t k = 0; k < (SUBSTRIP_MAX_LAYERS - 1); k++) {
+            _tLayers[k].pu16Active = (k < u8NbLayers) ? (pPool + (k + 1) * _u16NbLeds) : nullptr;
+            _tLayers[k].u16NbActive = SUBSTRIP_ACTIVE_STALE;
         }
+    }
+    return eRet;
+}
 
-        _ColorPalette = ColorPalette;
+/*******************************************************************************
+ * @brief Seed the random stream of the sub-strip, for a reproducible output
+ * @param u32Seed any value, the base and overlay effects share the stream
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eSetSeed(uint32_t u32Seed) {
+    _u32Rng = u32Seed ? u32Seed : 0x9E3779B9UL; // xorshift cannot leave 0
+    return RET_OK;
+}
+
+/*******************************************************************************
+ * @brief Give the particles of the drop and comet effects their storage
+ * @details Preallocated by the owner, spawning never allocates
+ * @param pPool (1 + u8NbLayers) * SUBSTRIP_MAX_PARTICLES, base layer first
+ * @param u8NbLayers overlay layers with particles, the others have none
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eSetParticlePool(TstParticle *pPool, uint8_t u8NbLayers) {
+    TeRetVal eRet = RET_OK;
+    if (pPool == nullptr) {
+        _MNG_RETURN(RET_NULLPTR);
+    }
+    else if (u8NbLayers > (SUBSTRIP_MAX_LAYERS - 1)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        _pParticles = pPool;
+        _u8NbParticles = 0;
+        for (uint8_t k = 0; k < (SUBSTRIP_MAX_LAYERS - 1); k++) {
+            _tLayers[k].pParticles = (k < u8NbLayers) ? (pPool + (k + 1) * SUBSTRIP_MAX_PARTICLES) : nullptr;
+            _tLayers[k].u8NbParticles = 0;
+        }
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Launch a particle
+ * @param i32Pos Q8 start position
+ * @param i16Vel Q8 pixels per step, negative toward the first pixel
+ * @param u8Color palette index
+ * @param u8Decay head brightness lost per step, 0 to cross the whole sub-strip
+ * @return false if the pool is full or missing, the particle is dropped
+ ******************************************************************************/
+bool SubStrip::bSpawnParticle(int32_t i32Pos, int16_t i16Vel, uint8_t u8Color, uint8_t u8Decay) {
+    if ((_pParticles == nullptr) || (_u8NbParticles >= SUBSTRIP_MAX_PARTICLES))
+    { return false; }
+    TstParticle &rParticle = _pParticles[_u8NbParticles++];
+    rParticle.i32Pos = i32Pos;
+    rParticle.i16Vel = i16Vel;
+    rParticle.u8Color = u8Color;
+    rParticle.u8Level = 255;
+    rParticle.u8Decay = u8Decay;
+    return true;
+}
+
+/*******************************************************************************
+ * @brief Move the particles and paint their heads, from an effect vStep()
+ * @details Each step paints the head pixel then advances it. A particle leaving
+ *          the sub-strip or fully decayed is replaced by the last one, the pool
+ *          stays packed.
+ * @param u16Steps animation steps due
+ ******************************************************************************/
+void SubStrip::vStepParticles(uint16_t u16Steps) {
+    uint8_t u8NbColors = (_pPalette != nullptr) ? _pPalette->u8GetNbColors() : 0;
+    if (!u8NbColors || !u16Steps)
+    { return; }
+    const CRGB *pColors = _pPalette->pGetColors();
+    int32_t i32End = (int32_t)_u16NbLeds << 8;
+    uint8_t p = 0;
+    while (p < _u8NbParticles) {
+        TstParticle &rParticle = _pParticles[p];
+        CRGB xColor = pColors[rParticle.u8Color % u8NbColors];
+        uint16_t u16Left = u16Steps;
+        for (; u16Left && (rParticle.i32Pos >= 0) && (rParticle.i32Pos < i32End) && rParticle.u8Level; u16Left--) {
+            uint16_t u16Scale = (uint16_t)rParticle.u8Level + 1;
+            vSetPixel(rParticle.i32Pos >> 8, CRGB((xColor.r * u16Scale) >> 8, (xColor.g * u16Scale) >> 8, (xColor.b * u16Scale) >> 8));
+            rParticle.i32Pos += rParticle.i16Vel;
+            rParticle.u8Level = (rParticle.u8Level > rParticle.u8Decay) ? (rParticle.u8Level - rParticle.u8Decay) : 0;
+            _bDirty = true;
+        }
+        if (u16Left)
+        { rParticle = _pParticles[--_u8NbParticles]; } // dead, p now holds the last one
+        else
+        { p++; }
+    }
+}
+
+uint8_t SubStrip::u8GetNbParticles(void) {
+    return _u8NbParticles;
+}
+
+/*******************************************************************************
+ * @brief Set an overlay layer, composited above the base animation
+ * @param u8Layer [1-(SUBSTRIP_MAX_LAYERS - 1)] layer, 0 is the base animation
+ * @param eAnim animation of the layer, NONE turns the layer off
+ * @param eBlend how the layer combines with the layers below
+ * @param u8Alpha opacity of the blended result
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eSetLayer(uint8_t u8Layer, TeAnimation eAnim, TeBlend eBlend, uint8_t u8Alpha) {
+    TeRetVal eRet = RET_OK;
+    if (!u8Layer || (u8Layer >= SUBSTRIP_MAX_LAYERS) || (eAnim >= NB_ANIMS) || (eBlend >= NB_BLENDS)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else if (_tLayers[u8Layer - 1].pLeds == nullptr) {
+        _MNG_RETURN(RET_INTERNAL_ERROR); // no pool for this layer
+    }
+    else {
+        TstLayer &rLayer = _tLayers[u8Layer - 1];
+        rLayer.eBlend = eBlend;
+        rLayer.u8Alpha = u8Alpha;
+        if (rLayer.eAnim != eAnim) {
+            _u8NbActiveLayers += (eAnim != NONE) - (rLayer.eAnim != NONE);
+            memset(rLayer.pLeds, 0, _u16NbLeds * sizeof(CRGB));
+            memset(rLayer.tu32FxState, 0, sizeof(rLayer.tu32FxState));
+            rLayer.eAnim = eAnim;
+            rLayer.u16Offset = _u16Offset;
+            vSwapLayer(rLayer);
+            eRet = tSubStripFx[_eCurrentAnimation].pfInit(*this, rLayer.tu32FxState);
+            vSwapLayer(rLayer);
+        }
+        _bDirty = true;
     }
     return eRet;
 }
@@ -227,11 +544,12 @@ void SubStrip::vTriggerAnim(void) {
 
 /*******************************************************************************
  * @brief Set animation speed, 1: fast, 255: slow
- * @details speed is expressed a multiple of animation callrate
+ * @details speed is expressed a multiple of the nominal SUBSTRIP_FPS period
  * @param u8Speed [1-255] fast -> slow
  ******************************************************************************/
 SubStrip::TeRetVal SubStrip::eSetSpeed(uint8_t u8Speed) {
     _u8Speed = u8Speed ? u8Speed : 1;
+    _u32StepInc = u32PeriodToInc((uint32_t)_u8Speed * _SUBSTRIP_PERIOD);
     return RET_OK;
 }
 
@@ -254,12 +572,10 @@ SubStrip::TeRetVal SubStrip::eSetFadeRate(uint16_t u16FadeDelay) {
         _MNG_RETURN(RET_BAD_PARAMETER);
     }
     else {
-        _u8FadeRate = u8FadeTimeToRate(u16FadeDelay);
+        _u32FadeInc = u32FadeTimeToInc(u16FadeDelay);
 #ifdef _TRACE_DBG
-            _TRACE_DBG("[Substrip] vSetFadeRate -> set: %u\r\n", _u8FadeRate);
+            _TRACE_DBG("[Substrip] vSetFadeRate -> set: %u\r\n", _u32FadeInc);
 #endif
-        if (!_u8FadeRate)
-        { _u8FadeRate = 1; }
     }
     return eRet;
 }
@@ -281,15 +597,16 @@ SubStrip::TeRetVal SubStrip::eSetDirection(TeDirection eDirection) {
 
 /*******************************************************************************
  * @brief Set the offset for the sub-strip
- * @param u8Offset The offset value
+ * @param u16Offset The offset value
  ******************************************************************************/
-SubStrip::TeRetVal SubStrip::eSetOffset(uint8_t u8Offset) {
+SubStrip::TeRetVal SubStrip::eSetOffset(uint16_t u16Offset) {
     TeRetVal eRet = RET_OK;
-    if (u8Offset > _u8NbLeds) {
+    if (u16Offset > _u16NbLeds) {
         _MNG_RETURN(RET_BAD_PARAMETER);
     }
     else {
-        _u8Offset = u8Offset;
+        _u16Offset = u16Offset % _u16NbLeds;
+        _bDirty = true;
     }
     return eRet;
 }
@@ -309,11 +626,99 @@ SubStrip::TeRetVal SubStrip::eSetBpm(uint8_t u8Bpm) {
     return eRet;
 }
 
+/*******************************************************************************
+ * @brief Set the target frame rate of the sub-strip
+ * @param u8Fps [1-SUBSTRIP_MAX_FPS] frames per second
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eSetFps(uint8_t u8Fps) {
+    TeRetVal eRet = RET_OK;
+    if (!u8Fps || (u8Fps > SUBSTRIP_MAX_FPS)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        _u16FramePeriod = 1000 / u8Fps;
+        _u32Deadline = _u32LastTick + _u16FramePeriod;
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Get the CLI/MQTT name of an animation
+ * @param eAnim animation
+ * @return name from the registry, nullptr if unknown
+ ******************************************************************************/
+const char *SubStrip::pcGetAnimName(TeAnimation eAnim) {
+    return (eAnim < NB_ANIMS) ? tSubStripFx[eAnim].pcName : nullptr;
+}
+
+/*******************************************************************************
+ * @brief Find an animation from its CLI/MQTT name
+ * @param pcName name, or the beginning of it
+ * @return animation, NB_ANIMS if unknown
+ ******************************************************************************/
+SubStrip::TeAnimation SubStrip::eGetAnimByName(const char *pcName) {
+    uint8_t u8Anim = 0;
+    if (pcName != nullptr) {
+        while ((u8Anim < NB_ANIMS) && (strncmp(pcName, tSubStripFx[u8Anim].pcName, strlen(pcName)) != 0)) {
+            u8Anim++;
+        }
+    }
+    else {
+        u8Anim = NB_ANIMS;
+    }
+    return (TeAnimation)u8Anim;
+}
+
+/*******************************************************************************
+ * @brief Get the CLI/MQTT name of a blend mode
+ * @param eBlend blend mode
+ * @return name, nullptr if out of range
+ ******************************************************************************/
+const char *SubStrip::pcGetBlendName(TeBlend eBlend) {
+    return (eBlend < NB_BLENDS) ? tcSubStripBlends[eBlend] : nullptr;
+}
+
+/*******************************************************************************
+ * @brief Find a blend mode from its CLI/MQTT name
+ * @param pcName name, or the beginning of it
+ * @return blend mode, NB_BLENDS if unknown
+ ******************************************************************************/
+SubStrip::TeBlend SubStrip::eGetBlendByName(const char *pcName) {
+    uint8_t u8Blend = 0;
+    if (pcName != nullptr) {
+        while ((u8Blend < NB_BLENDS) && (strncmp(pcName, tcSubStripBlends[u8Blend], strlen(pcName)) != 0)) {
+            u8Blend++;
+        }
+    }
+    else {
+        u8Blend = NB_BLENDS;
+    }
+    return (TeBlend)u8Blend;
+}
+
+/*******************************************************************************
+ * @brief Set the gradient width of the effects using one
+ * @param u8Width [2-SUBSTRIP_MAX_WIDTH] pixels
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eSetWidth(uint8_t u8Width) {
+    TeRetVal eRet = RET_OK;
+    if ((u8Width < 2) || (u8Width > SUBSTRIP_MAX_WIDTH)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else {
+        _u8Width = u8Width;
+        eRet = eInitFx();
+    }
+    return eRet;
+}
+
 /*******************************************************************************
  * @brief Clear the sub-strip by setting all LEDs to black.
  ******************************************************************************/
 void SubStrip::vClear(void) {
-    memset(_SubLeds, 0, _u8NbLeds * sizeof(CRGB));
+    memset(_SubLeds, 0, _u16NbLeds * sizeof(CRGB));
+    _u16NbActive = 0;
+    _bDirty = true;
 }
 
 /*******************************************************************************
@@ -321,7 +726,9 @@ void SubStrip::vClear(void) {
  * @param color The color to fill the sub-strip with.
  ******************************************************************************/
 void SubStrip::vFillColor(CRGB color) {
-    fill_solid(_SubLeds, _u8NbLeds, color);
+    vKernel_Fill(_SubLeds, _u16NbLeds, color);
+    _u16NbActive = SUBSTRIP_ACTIVE_STALE;
+    _bDirty = true;
 }
 
 /*******************************************************************************
@@ -330,7 +737,7 @@ void SubStrip::vFillColor(CRGB color) {
  ******************************************************************************/
 bool SubStrip::bIsBlack(void) {
     CRGB *pPixel = _SubLeds;
-    for (uint8_t i = 0; i < _u8NbLeds; i++) {
+    for (uint16_t i = 0; i < _u16NbLeds; i++) {
         if (*pPixel != CRGB::Black)
         { return false; }
         pPixel++;
@@ -338,25 +745,146 @@ bool SubStrip::bIsBlack(void) {
     return true; // All LEDs are black
 }
 
+/*******************************************************************************
+ * @brief Check if pixels changed since the last call to vClearDirty()
+ * @return true if the sub-strip has to be composed again
+ ******************************************************************************/
+bool SubStrip::bIsDirty(void) {
+    return _bDirty;
+}
+
+/*******************************************************************************
+ * @brief Acknowledge pixel changes, once the sub-strip has been composed
+ ******************************************************************************/
+void SubStrip::vClearDirty(void) {
+    _bDirty = false;
+}
+
+/*******************************************************************************
+ * @brief Time the pixels will stay unchanged for, if nothing is posted
+ * @details Asked by the render once a frame changed nothing: the base effect
+ *          and the overlay layers answer, the shortest wait wins.
+ * @param u32Now current time in milliseconds
+ * @return milliseconds, 0 if the next frame may change, SUBSTRIP_IDLE_FOREVER
+ *         if the sub-strip is static
+ ******************************************************************************/
+uint32_t SubStrip::u32GetIdleMs(uint32_t u32Now) {
+    if ((_SubLeds == nullptr) || _bDirty || _u32XfadeInc)
+    { return 0; }
+    uint32_t u32Idle = tSubStripFx[_eCurrentAnimation].pfIdleMs(*this, _tu32FxState, u32Now);
+    for (uint8_t k = 0; u32Idle && _u8NbActiveLayers && (k < (SUBSTRIP_MAX_LAYERS - 1)); k++) {
+        TstLayer &rLayer = _tLayers[k];
+        if (rLayer.eAnim != NONE) {
+            vSwapLayer(rLayer);
+            uint32_t u32Layer = tSubStripFx[_eCurrentAnimation].pfIdleMs(*this, rLayer.tu32FxState, u32Now);
+            vSwapLayer(rLayer);
+            u32Idle = (u32Layer < u32Idle) ? u32Layer : u32Idle;
+        }
+    }
+    return u32Idle;
+}
+
 /******************************************************************************/
 /* Private methods                                                            */
 /******************************************************************************/
 
+/*******************************************************************************
+ * @brief Rotation head applied when the sub-strip is composited
+ * @return Number of pixels the content is rotated forward (Din -> Dout)
+ ******************************************************************************/
+uint16_t SubStrip::u16GetRotation(void) {
+    return tSubStripFx[_eCurrentAnimation].bRotate ? _u16Offset : 0;
+}
+
+/*******************************************************************************
+ * @brief Exchange the effect context (pixels, rotation head, animation) with
+ *        a layer: effects then run unchanged on the layer. Called in pairs.
+ ******************************************************************************/
+void SubStrip::vSwapLayer(TstLayer &rLayer) {
+    CRGB *pLeds = _SubLeds;
+    uint16_t u16Offset = _u16Offset;
+    TeAnimation eAnim = _eCurrentAnimation;
+    uint16_t *pu16Active = _pu16Active;
+    uint16_t u16NbActive = _u16NbActive;
+    TstParticle *pParticles = _pParticles;
+    uint8_t u8NbParticles = _u8NbParticles;
+    _SubLeds = rLayer.pLeds;
+    _u16Offset = rLayer.u16Offset;
+    _eCurrentAnimation = rLayer.eAnim;
+    _pu16Active = rLayer.pu16Active;
+    _u16NbActive = rLayer.u16NbActive;
+    _pParticles = rLayer.pParticles;
+    _u8NbParticles = rLayer.u8NbParticles;
+    rLayer.pLeds = pLeds;
+    rLayer.u16Offset = u16Offset;
+    rLayer.eAnim = eAnim;
+    rLayer.pu16Active = pu16Active;
+    rLayer.u16NbActive = u16NbActive;
+    rLayer.pParticles = pParticles;
+    rLayer.u8NbParticles = u8NbParticles;
+}
+
+/*******************************************************************************
+ * @brief Initialize the base and overlay effects again (palette, width)
+ * @return status of the base effect
+ ******************************************************************************/
+SubStrip::TeRetVal SubStrip::eInitFx(void) {
+    TeRetVal eRet = tSubStripFx[_eCurrentAnimation].pfInit(*this, _tu32FxState);
+    for (uint8_t k = 0; _u8NbActiveLayers && (k < (SUBSTRIP_MAX_LAYERS - 1)); k++) {
+        TstLayer &rLayer = _tLayers[k];
+        if (rLayer.eAnim != NONE) {
+            vSwapLayer(rLayer);
+            tSubStripFx[_eCurrentAnimation].pfInit(*this, rLayer.tu32FxState);
+            vSwapLayer(rLayer);
+        }
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Combine one layer pixel with the pixel below it
+ * @param xBelow result of the layers below
+ * @param xLayer layer pixel
+ * @param eBlend blend mode
+ * @param u8Alpha opacity of the blended result
+ ******************************************************************************/
+static inline CRGB xBlendPixel(CRGB xBelow, const CRGB &xLayer, SubStrip::TeBlend eBlend, uint8_t u8Alpha) {
+    CRGB xTop;
+    switch (eBlend) {
+        case SubStrip::BLEND_ADD:
+        xTop = CRGB(qadd8(xBelow.r, xLayer.r), qadd8(xBelow.g, xLayer.g), qadd8(xBelow.b, xLayer.b));
+        break;
+
+        case SubStrip::BLEND_MAX:
+        xTop = CRGB((xBelow.r > xLayer.r) ? xBelow.r : xLayer.r,
+                    (xBelow.g > xLayer.g) ? xBelow.g : xLayer.g,
+                    (xBelow.b > xLayer.b) ? xBelow.b : xLayer.b);
+        break;
+
+        case SubStrip::BLEND_MULTIPLY:
+        xTop = CRGB(scale8(xBelow.r, xLayer.r), scale8(xBelow.g, xLayer.g), scale8(xBelow.b, xLayer.b));
+        break;
+
+        case SubStrip::BLEND_ALPHA:
+        default:
+        xTop = xLayer;
+        break;
+    }
+    return (u8Alpha == 255) ? xTop : xKernel_BlendPixel(xBelow, xTop, u8Alpha);
+}
+
 /*******************************************************************************
  * @brief Shift leds forward (Din -> Dout)
+ * @details O(1): only the rotation head moves, pixels stay in place
  * @param Color pointer to color to feed, nullptr will feed last color back
  ******************************************************************************/
 void SubStrip::vShiftFwd(CRGB *Color) {
-    CRGB last = (Color != nullptr) ? *Color : _SubLeds[_u8NbLeds - 1];
-    CRGB* pLeds = _SubLeds + _u8NbLeds - 1;
-
-    for (uint8_t i = 0; i < _u8NbLeds; i++) {
-        *pLeds = *(pLeds - 1);
-        pLeds--;
+    _u16Offset = (_u16Offset + 1 < _u16NbLeds) ? (_u16Offset + 1) : 0;
+    if (Color != nullptr) {
+        // displayed[0] is base[n - head]
+        _SubLeds[_u16Offset ? (_u16NbLeds - _u16Offset) : 0] = *Color;
     }
-    _SubLeds[0] = last;
-    _u8Offset++;
-    _u8Offset %= _u8NbLeds;
+    _bDirty = true;
 }
 
 /*******************************************************************************
@@ -369,19 +897,16 @@ void SubStrip::vInsertFwd(CRGB ColorFeed) {
 
 /*******************************************************************************
  * @brief Shift leds backward (Dout -> Din)
+ * @details O(1): only the rotation head moves, pixels stay in place
  * @param Color pointer to color to feed, nullptr will feed first color back
  ******************************************************************************/
 void SubStrip::vShiftBwd(CRGB *Color) {
-    CRGB first = (Color != nullptr) ? *Color : _SubLeds[0];
-    CRGB* pLeds = _SubLeds;
-
-    for (uint8_t i = 0; i < _u8NbLeds - 1; i++) {
-        *pLeds = *(pLeds + 1);
-        pLeds++;
+    _u16Offset = _u16Offset ? (_u16Offset - 1) : (_u16NbLeds - 1);
+    if (Color != nullptr) {
+        // displayed[n - 1] is base[n - 1 - head]
+        _SubLeds[_u16NbLeds - 1 - _u16Offset] = *Color;
     }
-    _SubLeds[_u8NbLeds - 1] = first;
-    _u8Offset++;
-    _u8Offset %= _u8NbLeds;
+    _bDirty = true;
 }
 
 /*******************************************************************************
@@ -392,106 +917,141 @@ void SubStrip::vInsertBwd(CRGB ColorFeed) {
     vShiftBwd(&ColorFeed);
 }
 
-uint8_t SubStrip::u8FadeTimeToRate(uint16_t u16FadeTime) {
-    return ((255*_SUBSTRIP_PERIOD)/u16FadeTime);
+/*******************************************************************************
+ * @brief Step phase increment per millisecond
+ * @param u32PeriodMs duration of one animation step
+ * @return Q16 increment, rounded up so that a nominal frame never loses a step
+ ******************************************************************************/
+uint32_t SubStrip::u32PeriodToInc(uint32_t u32PeriodMs) {
+    return (_PHASE_ONE + u32PeriodMs - 1) / u32PeriodMs;
 }
 
 /*******************************************************************************
- * @brief Manage glitter animation
+ * @brief Fade phase increment per millisecond
+ * @param u16FadeTime time for a full 255 fade, in milliseconds
+ * @return Q16 fade amount per millisecond
  ******************************************************************************/
-void SubStrip::vAnimateGlitter() {
-    // Placeholder for glitter animation
-    fadeToBlackBy(_SubLeds, _u8NbLeds, _u8FadeRate);
-    if ((_u8DelayRate % _u8Speed) == 0) {
-        _u8DelayRate = 0;
-        CRGB *pPixel = nullptr;
-        for (uint8_t i = 0; i < _u8ColorNb; i++) {
-            pPixel = _SubLeds + (random8() % _u8NbLeds);
-            // if (*pPixel == CRGB::Black)
-            { *pPixel = _ColorPalette[i]; }
-        }
-    }
-    _u8DelayRate++;
+uint32_t SubStrip::u32FadeTimeToInc(uint16_t u16FadeTime) {
+    return (255 * _PHASE_ONE) / u16FadeTime;
 }
 
 /*******************************************************************************
- * @brief Manage raindrop animation
+ * @brief Advance the step accumulator
+ * @param u32Elapsed elapsed time in milliseconds
+ * @return Number of animation steps due
  ******************************************************************************/
-void SubStrip::vAnimateRaindrops() {
-    if (_ColorPalette == nullptr)
-    { return; }
-    
-    // if ((_u8DelayRate % _u8Speed) == 0)
-    { fadeToBlackBy(_SubLeds, _u8NbLeds, _u8FadeRate); }
+uint16_t SubStrip::u16AdvanceSteps(uint32_t u32Elapsed) {
+    _u32StepPhase += u32Elapsed * _u32StepInc;
+    uint16_t u16Steps = _u32StepPhase >> 16;
+    _u32StepPhase &= (_PHASE_ONE - 1);
+    return u16Steps;
+}
 
-    if (_bTrigger && ((_u8Index >= _u8NbLeds) || !_u8Index)) {
-        _bTrigger = false;
-        _u8Index = 0;
-        _pPixel = _SubLeds;
+/*******************************************************************************
+ * @brief Advance the fade accumulator
+ * @param u32Elapsed elapsed time in milliseconds
+ * @return Fade amount due, as fadeToBlackBy()
+ ******************************************************************************/
+uint8_t SubStrip::u8AdvanceFade(uint32_t u32Elapsed) {
+    if (u32Elapsed && (_u32FadeInc >= (255 * _PHASE_ONE) / u32Elapsed)) {
+        _u32FadePhase = 0; // full fade due, also keeps the product below
+        return 255;
     }
+    _u32FadePhase += u32Elapsed * _u32FadeInc;
+    uint32_t u32Fade = _u32FadePhase >> 16;
+    _u32FadePhase &= (_PHASE_ONE - 1);
+    return (u32Fade > 255) ? 255 : (uint8_t)u32Fade;
+}
 
-    if ((_u8DelayRate % _u8Speed) == 0) {
-        _u8DelayRate = 0;
-        if ((_pPixel != nullptr) && (_u8Index < _u8NbLeds)) {
-            *_pPixel = *_ColorPalette;
-            _u8Index++;
-            _pPixel++;
-        }
-    }
-    _u8DelayRate++;
+/*******************************************************************************
+ * @brief beatsin8() driven by the given time instead of millis(), 16-bit range
+ ******************************************************************************/
+uint16_t SubStrip::u16BeatSin(uint32_t u32Now, uint16_t u16Low, uint16_t u16High) {
+    // beat88(): 280 = 65536 / 60000 * 256 in Q16, wraps like FastLED does
+    uint16_t u16Beat = (u32Now * ((uint32_t)_u8Bpm << 8) * 280) >> 16;
+    uint8_t u8Sin = sin8((uint8_t)((u16Beat >> 8) + _u16Offset));
+    // scale8() widened to 16-bit ranges, identical below 256
+    return u16Low + (((uint32_t)u8Sin * (1 + u16High - u16Low)) >> 8);
 }
 
 /*******************************************************************************
- * @brief Manage chechered animation
+ * @brief Fade the whole sub-strip toward black
+ * @param u8Rate fade amount, same as fadeToBlackBy()
+ * @return true if at least one pixel changed
  ******************************************************************************/
-void SubStrip::vAnimateCheckered() {
-    // Placeholder for checkered animation
-    if ((_u8DelayRate % _u8Speed) == 0) {
-        _u8DelayRate = 0;
-        if (_eDirection == FORWARD_INOUT)
-        { vShiftFwd(nullptr); }
-        else
-        { vShiftBwd(nullptr); }
-    }
-    _u8DelayRate++;
+bool SubStrip::bFadeAll(uint8_t u8Rate) {
+    bool bChanged = bKernel_Fade(_SubLeds, _u16NbLeds, u8Rate);
+    _u16NbActive = SUBSTRIP_ACTIVE_STALE;
+    _bDirty |= bChanged;
+    return bChanged;
 }
 
 /*******************************************************************************
- * @brief Manage wave animation
+ * @brief Fade the lit pixels only, they leave the list once black
+ * @details Same result as bFadeAll(), at a cost proportional to the lit
+ *          pixels. Without an active pool the whole sub-strip is faded.
+ * @param u8Rate fade amount
+ * @return true if a pixel changed
  ******************************************************************************/
-void SubStrip::vAnimateWave(void) {
-    if (_ColorPalette && (_u8ColorNb >= 2)) {
-        uint8_t u8Pos = beatsin8(_u8Bpm, 0, _u8NbLeds-6, 0, _u8Offset);
-        vClear();
-        fill_solid(_SubLeds, u8Pos, _ColorPalette[0]);
-        fill_solid(_SubLeds + u8Pos, _u8NbLeds - u8Pos, _ColorPalette[1]);
-        fill_gradient_RGB(_SubLeds + u8Pos, 6, _ColorPalette[0], _ColorPalette[1]);
-    }
+bool SubStrip::bFadeActive(uint8_t u8Rate) {
+    if (_pu16Active == nullptr)
+    { return bFadeAll(u8Rate); }
+    if (_u16NbActive == SUBSTRIP_ACTIVE_STALE)
+    { vScanActive(); }
+    bool bChanged = bKernel_FadeSparse(_SubLeds, _pu16Active, &_u16NbActive, u8Rate);
+    _bDirty |= bChanged;
+    return bChanged;
 }
 
 /*******************************************************************************
- * @brief Initialize checkered animation
+ * @brief Write a pixel of a sparse effect and keep the active list exact
+ * @param u16Index pixel, below _u16NbLeds
+ * @param xColor new color
  ******************************************************************************/
-SubStrip::TeRetVal SubStrip::eInitCheckered() {
-    TeRetVal eRet = RET_OK;
-    if ((!_u8ColorNb) || (_ColorPalette == nullptr)){
-        _MNG_RETURN(RET_INTERNAL_ERROR);
+void SubStrip::vSetPixel(uint16_t u16Index, CRGB xColor) {
+    CRGB &rPixel = _SubLeds[u16Index];
+    if ((_pu16Active != nullptr) && (_u16NbActive != SUBSTRIP_ACTIVE_STALE)) {
+        if (!rPixel && xColor)
+        { _pu16Active[_u16NbActive++] = u16Index; } // black pixels are never listed
+        else if (rPixel && !xColor)
+        { _u16NbActive = SUBSTRIP_ACTIVE_STALE; } // listed but black, rare: rebuild
     }
-    else {
-        uint8_t u8Repeat = _u8NbLeds / _u8ColorNb;
-        CRGB* pLed = _SubLeds;
-        CRGB* pColor = _ColorPalette;
-
-        for (uint8_t i = 0; i < _u8NbLeds; i++) {
-            if (((i + _u8Offset) % u8Repeat == 0) && i) {
-                pColor++;
-                if ((pColor - _ColorPalette) >= _u8ColorNb) {
-                    pColor = _ColorPalette;
-                }
-            }
-            *pLed = *pColor;
-            pLed++;
+    rPixel = xColor;
+}
+
+/*******************************************************************************
+ * @brief Rebuild the active list from the pixels, once per untracked write
+ ******************************************************************************/
+void SubStrip::vScanActive(void) {
+    if (_pu16Active != nullptr) {
+        _u16NbActive = 0;
+        for (uint16_t i = 0; i < _u16NbLeds; i++) {
+            if (_SubLeds[i])
+            { _pu16Active[_u16NbActive++] = i; }
         }
     }
-    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Check that a sparse effect has nothing left to fade nor to move
+ * @return true when no particle flies and every pixel is black
+ ******************************************************************************/
+bool SubStrip::bIsFaded(void) {
+    if (_u8NbParticles)
+    { return false; }
+    if ((_pu16Active == nullptr) || (_u16NbActive == SUBSTRIP_ACTIVE_STALE))
+    { return bIsBlack(); }
+    return (_u16NbActive == 0);
+}
+
+/*******************************************************************************
+ * @brief Next value of the sub-strip random stream (xorshift32)
+ ******************************************************************************/
+uint16_t SubStrip::u16Random(void) {
+    uint32_t x = _u32Rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _u32Rng = x;
+    return (uint16_t)(x >> 16);
 }
@@ -12,8 +12,48 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include "Palette.h"
+#include "OutputLut.h"
 
 #define SUBSTRIP_FPS               50
+#define SUBSTRIP_MAX_FPS           100
+#define SUBSTRIP_STOP_PERIODIC     (uint32_t)(-1)
+#define SUBSTRIP_FX_STATE_SIZE     56 // bytes of effect state per sub-strip
+#define SUBSTRIP_MAX_WIDTH         16 // longest gradient of an effect
+#define SUBSTRIP_MAX_LEDS          2048 // longest sub-strip
+#define SUBSTRIP_MAX_LAYERS        3 // base layer included
+#define SUBSTRIP_ACTIVE_STALE      ((uint16_t)0xFFFF) // active pixel list to be rebuilt
+#define SUBSTRIP_MAX_PARTICLES     32 // particles in flight per layer
+#define SUBSTRIP_IDLE_FOREVER      ((uint32_t)(-1)) // static until a parameter change
+
+/*
+ * Animation registry: one line per effect, (enum, CLI/MQTT name, effect type).
+ * The effect type is declared in SubStrip_Fx.h, the dispatch table is built
+ * from this list at compile time in SubStrip_Fx.cpp.
+ */
+#define FOREACH_SUBSTRIP_ANIM(ANIM)                 \
+    ANIM(NONE,          none,           FxNone)         \
+    ANIM(GLITTER,       glitter,        FxGlitter)      \
+    ANIM(RAINDROPS,     raindrops,      FxRaindrops)    \
+    ANIM(CHECKERED,     checkered,      FxCheckered)    \
+    ANIM(WAVE,          wave,           FxWave)         \
+    ANIM(COMETS,        comets,         FxComets)
+
+#define GENERATE_ANIM_ENUM(ENUM, NAME, FX)      ENUM,
+#define GENERATE_ANIM_FRIEND(ENUM, NAME, FX)    friend struct FX;
+
+/*
+ * Blend modes of the overlay layers, (enum, CLI/MQTT name). A layer pixel is
+ * first combined with what lies below, the result is then mixed with the
+ * layer alpha: out = blend(below, op(below, layer), alpha).
+ */
+#define FOREACH_SUBSTRIP_BLEND(BLEND)               \
+    BLEND(BLEND_ADD,        add)                    \
+    BLEND(BLEND_MAX,        max)                    \
+    BLEND(BLEND_ALPHA,      alpha)                  \
+    BLEND(BLEND_MULTIPLY,   multiply)
+
+#define GENERATE_BLEND_ENUM(ENUM, NAME)         ENUM,
 
 class SubStrip {
 public:
@@ -27,72 +67,155 @@ public:
     } TeRetVal;
 
     typedef enum {
-        NONE,
-        GLITTER,
-        RAINDROPS,
-        CHECKERED,
-        WAVE,
+        FOREACH_SUBSTRIP_ANIM(GENERATE_ANIM_ENUM)
         NB_ANIMS
     } TeAnimation;
 
+    typedef enum {
+        FOREACH_SUBSTRIP_BLEND(GENERATE_BLEND_ENUM)
+        NB_BLENDS
+    } TeBlend;
+
     typedef enum {
         FORWARD_INOUT,
         REVERSE_OUTIN
     } TeDirection;
 
-    SubStrip(uint8_t u8NbLeds, CRGB *pLeds);
+    typedef struct {
+        uint32_t u32Now; // current time in milliseconds
+        uint16_t u16Steps; // animation steps due since the previous frame
+        uint8_t u8Fade; // fade amount due since the previous frame
+    } TstTick;
+
+    /*
+     * Moving head of a drop or comet, its trail is left by the fade of the
+     * effect. Particles are kept packed at the start of the pool.
+     */
+    typedef struct {
+        int32_t i32Pos; // Q8 pixel position
+        int16_t i16Vel; // Q8 pixels per step, at most one pixel for a gapless trail
+        uint8_t u8Color; // palette index
+        uint8_t u8Level; // head brightness, dead at 0
+        uint8_t u8Decay; // level lost per step
+    } TstParticle;
+
+    SubStrip(uint16_t u16NbLeds, CRGB *pLeds);
     ~SubStrip();
-    TeRetVal eGetSubStrip(CRGB *leds, uint8_t u8NbLeds);
-    TeRetVal eSetSubStrip(CRGB *leds, uint8_t u8NbLeds);
+    TeRetVal eGetSubStrip(CRGB *leds, uint16_t u16NbLeds, const OutputLut *pLut = nullptr);
+    TeRetVal eSetSubStrip(CRGB *leds, uint16_t u16NbLeds);
     void vManageAnimation(uint32_t u32Now); // to be called into loop()
+    bool bIsDue(uint32_t u32Now);
+    uint32_t u32GetDeadline(void);
+    uint16_t u16GetFramePeriod(void);
     TeRetVal eSetAnimation(TeAnimation eAnim);
-    TeRetVal eSetAnimation(TeAnimation eAnim, CRGB *pPalette);
-    TeRetVal eSetAnimation(TeAnimation eAnim, CRGB *pPalette, uint32_t u32Period);
-    TeRetVal eSetAnimation(TeAnimation eAnim, CRGB *pPalette, uint32_t u32Period, uint8_t u8Speed);
-    TeRetVal eSetColorPalette(CRGB *ColorPalette);
+    TeRetVal eSetAnimation(TeAnimation eAnim, const Palette *pPalette);
+    TeRetVal eSetAnimation(TeAnimation eAnim, const Palette *pPalette, uint32_t u32Period);
+    TeRetVal eSetAnimation(TeAnimation eAnim, const Palette *pPalette, uint32_t u32Period, uint8_t u8Speed);
+    TeRetVal eCrossfade(TeAnimation eAnim, uint16_t u16Ms);
+    TeRetVal eSetTransitionBuffer(CRGB *pBuffer);
+    TeRetVal eSetColorPalette(const Palette *pPalette);
+    TeRetVal eSetLayerPool(CRGB *pPool, uint8_t u8NbLayers = SUBSTRIP_MAX_LAYERS - 1);
+    TeRetVal eSetLayer(uint8_t u8Layer, TeAnimation eAnim, TeBlend eBlend, uint8_t u8Alpha);
+    TeRetVal eSetActivePool(uint16_t *pPool, uint8_t u8NbLayers = SUBSTRIP_MAX_LAYERS - 1);
+    TeRetVal eSetSeed(uint32_t u32Seed);
+    TeRetVal eSetParticlePool(TstParticle *pPool, uint8_t u8NbLayers = SUBSTRIP_MAX_LAYERS - 1);
+    bool bSpawnParticle(int32_t i32Pos, int16_t i16Vel, uint8_t u8Color, uint8_t u8Decay);
+    void vStepParticles(uint16_t u16Steps);
+    uint8_t u8GetNbParticles(void);
     void vTriggerAnim(void);
     TeRetVal eSetSpeed(uint8_t u8Speed);
     TeRetVal eSetPeriod(uint32_t u32Period);
     TeRetVal eSetFadeRate(uint16_t u16FadeDelay);
     TeRetVal eSetDirection(TeDirection eDirection);
-    TeRetVal eSetOffset(uint8_t u8Offset);
+    TeRetVal eSetOffset(uint16_t u16Offset);
     TeRetVal eSetBpm(uint8_t u8Bpm);
+    TeRetVal eSetFps(uint8_t u8Fps);
+    TeRetVal eSetWidth(uint8_t u8Width);
     void vClear(void);
     void vFillColor(CRGB color);
     bool bIsBlack(void);
+    bool bIsDirty(void);
+    uint32_t u32GetIdleMs(uint32_t u32Now);
+    void vClearDirty(void);
+    static const char *pcGetAnimName(TeAnimation eAnim);
+    static TeAnimation eGetAnimByName(const char *pcName);
+    static const char *pcGetBlendName(TeBlend eBlend);
+    static TeBlend eGetBlendByName(const char *pcName);
 
 private:
+    FOREACH_SUBSTRIP_ANIM(GENERATE_ANIM_FRIEND)
+
+    typedef struct {
+        CRGB *pLeds; // slice of the layer pool, nullptr until first set
+        TeAnimation eAnim; // NONE: layer off
+        TeBlend eBlend;
+        uint8_t u8Alpha;
+        uint16_t u16Offset; // rotation head of the layer
+        uint16_t *pu16Active; // lit pixels of the layer, slice of the active pool
+        uint16_t u16NbActive;
+        TstParticle *pParticles; // slice of the particle pool
+        uint8_t u8NbParticles;
+        uint32_t tu32FxState[SUBSTRIP_FX_STATE_SIZE / sizeof(uint32_t)];
+    } TstLayer;
+
     /* Global object parameter */
     CRGB *_SubLeds;  // Pointer to the LED array
-    CRGB *_ColorPalette; // Pointer to the color palette
+    const Palette *_pPalette; // shared color palette
     bool _bDynamic; //dynamic memory allocation of CRGB substrip
-    uint8_t _u8ColorNb; // Number of colors in the palette
-    uint8_t _u8NbLeds; // Number of LEDs in the sub-strip
+    uint8_t _u8PaletteRev; // palette revision the effect was initialized with
+    uint16_t _u16NbLeds; // Number of LEDs in the sub-strip
 
     /* Animation parameters */
-    uint8_t _u8Speed; // Animation speed, aka prescaler
+    uint8_t _u8Speed; // Animation speed, in nominal frame periods per step
+    uint32_t _u32StepInc; // Q16 step phase per millisecond
+    uint32_t _u32StepPhase; // Q16 step phase accumulator
+    uint32_t _u32FadeInc; // Q16 fade amount per millisecond
+    uint32_t _u32FadePhase; // Q16 fade amount accumulator
+    uint32_t _u32LastTick; // time of the previous vManageAnimation() call
+    uint32_t _u32Deadline; // time of the next vManageAnimation() call
+    uint16_t _u16FramePeriod; // ms, from the target frame rate
+    bool _bClockSync;
     uint32_t _u32Period; // Animation period
-    uint32_t _u32Timeout; // Current time for animation timing
     TeDirection _eDirection = FORWARD_INOUT;
-    uint8_t _u8Index;
-    uint8_t _u8DelayRate;
-    uint8_t _u8FadeRate;
-    uint8_t _u8Offset;
+    uint16_t _u16Offset; // Rotation head, applied when composited
     uint8_t _u8Bpm;
-    CRGB *_pPixel;
+    uint8_t _u8Width; // gradient width, in pixels
+    uint32_t _tu32FxState[SUBSTRIP_FX_STATE_SIZE / sizeof(uint32_t)]; // state of the current effect
+    TstLayer _tLayers[SUBSTRIP_MAX_LAYERS - 1]; // overlay layers, above the base one
+    CRGB *_pLayerPool; // (SUBSTRIP_MAX_LAYERS - 1) * _u16NbLeds pixels
+    uint8_t _u8NbActiveLayers; // overlay layers with an animation
+    uint16_t *_pu16Active; // indexes of the lit pixels, nullptr: no tracking
+    uint16_t _u16NbActive; // SUBSTRIP_ACTIVE_STALE after an untracked write
+    uint32_t _u32Rng; // xorshift32 state, per sub-strip stream
+    TstParticle *_pParticles; // SUBSTRIP_MAX_PARTICLES, nullptr: no particle
+    uint8_t _u8NbParticles; // in flight, packed at the start of _pParticles
+    CRGB *_pTransition; // image faded out by a crossfade, in display order
+    uint32_t _u32XfadeInc; // Q16 crossfade progress per millisecond, 0: no crossfade
+    uint32_t _u32XfadePhase; // Q16 weight of the new animation
 
     bool _bTrigger;
+    bool _bDirty; // pixels changed since last vClearDirty()
     TeAnimation _eCurrentAnimation = NONE;
+    uint16_t u16GetRotation(void);
+    void vSwapLayer(TstLayer &rLayer);
+    TeRetVal eInitFx(void);
     void vShiftFwd(CRGB *Color);
     void vInsertFwd(CRGB ColorFeed);
     void vShiftBwd(CRGB *Color);
     void vInsertBwd(CRGB ColorFeed);
-    uint8_t u8FadeTimeToRate(uint16_t u16FadeTime);
-    void vAnimateGlitter(void);
-    void vAnimateRaindrops(void);
-    void vAnimateCheckered(void);
-    void vAnimateWave(void);
-    TeRetVal eInitCheckered(void);
+    uint32_t u32PeriodToInc(uint32_t u32PeriodMs);
+    uint32_t u32FadeTimeToInc(uint16_t u16FadeTime);
+    uint16_t u16AdvanceSteps(uint32_t u32Elapsed);
+    uint8_t u8AdvanceFade(uint32_t u32Elapsed);
+    uint16_t u16BeatSin(uint32_t u32Now, uint16_t u16Low, uint16_t u16High);
+    bool bFadeAll(uint8_t u8Rate);
+    bool bFadeActive(uint8_t u8Rate);
+    void vSetPixel(uint16_t u16Index, CRGB xColor);
+    void vScanActive(void);
+    bool bIsFaded(void);
+    uint16_t u16Random(void);
 };
 
+#include "SubStrip_Fx.h"
+
 #endif // _SUBSTRIP_H
@@ -0,0 +1,317 @@
+/**
+ * @file SubStrip_Fx.cpp
+ * @brief Effects of the SubStrip animation registry.
+ * @author Nello
+ * @date 2025-10-14
+ */
+
+#include "SubStrip.h"
+#include "Kernels.h"
+
+
+#define _MNG_RETURN(x)  eRet = x
+
+/******************************************************************************/
+/* Registry                                                                   */
+/******************************************************************************/
+
+template <class Fx>
+static SubStrip::TeRetVal eFxInit(SubStrip &rStrip, void *pvState) {
+    static_assert(sizeof(typename Fx::TstState) <= SUBSTRIP_FX_STATE_SIZE, "effect state exceeds SUBSTRIP_FX_STATE_SIZE");
+    return Fx::eInit(rStrip, *(typename Fx::TstState *)pvState);
+}
+
+template <class Fx>
+static void vFxStep(SubStrip &rStrip, void *pvState, const SubStrip::TstTick &stTick) {
+    Fx::vStep(rStrip, *(typename Fx::TstState *)pvState, stTick);
+}
+
+template <class Fx>
+static uint32_t u32FxIdleMs(SubStrip &rStrip, void *pvState, uint32_t u32Now) {
+    return Fx::u32IdleMs(rStrip, *(typename Fx::TstState *)pvState, u32Now);
+}
+
+#define GENERATE_ANIM_FX(ENUM, NAME, FX)    {&eFxInit<FX>, &vFxStep<FX>, &u32FxIdleMs<FX>, #NAME, FX::bRotate},
+
+const TstSubStripFx tSubStripFx[SubStrip::NB_ANIMS] = {
+    FOREACH_SUBSTRIP_ANIM(GENERATE_ANIM_FX)
+};
+
+/******************************************************************************/
+/* NONE                                                                       */
+/******************************************************************************/
+
+SubStrip::TeRetVal FxNone::eInit(SubStrip &rStrip, TstState &rState) {
+    (void)rStrip;
+    (void)rState;
+    return SubStrip::RET_OK;
+}
+
+void FxNone::vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick) {
+    (void)rStrip;
+    (void)rState;
+    (void)stTick;
+}
+
+uint32_t FxNone::u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now) {
+    (void)rStrip;
+    (void)rState;
+    (void)u32Now;
+    return SUBSTRIP_IDLE_FOREVER;
+}
+
+/******************************************************************************/
+/* GLITTER                                                                    */
+/******************************************************************************/
+
+SubStrip::TeRetVal FxGlitter::eInit(SubStrip &rStrip, TstState &rState) {
+    (void)rState;
+    rStrip.vScanActive(); // sparkles are tracked from now on
+    return SubStrip::RET_OK;
+}
+
+/*******************************************************************************
+ * @brief Manage glitter animation
+ ******************************************************************************/
+void FxGlitter::vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick) {
+    (void)rState;
+    rStrip.bFadeActive(stTick.u8Fade);
+    for (uint16_t u16Steps = stTick.u16Steps; u16Steps; u16Steps--) {
+        uint8_t u8NbColors = rStrip._pPalette ? rStrip._pPalette->u8GetNbColors() : 0;
+        for (uint8_t i = 0; i < u8NbColors; i++) {
+            rStrip.vSetPixel(rStrip.u16Random() % rStrip._u16NbLeds, rStrip._pPalette->pGetColors()[i]);
+        }
+        rStrip._bDirty |= (u8NbColors != 0);
+    }
+}
+
+/*******************************************************************************
+ * @brief Glitter is static once the palette is empty and the sparkles faded
+ ******************************************************************************/
+uint32_t FxGlitter::u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now) {
+    (void)rState;
+    (void)u32Now;
+    bool bNoColor = (rStrip._pPalette == nullptr) || !rStrip._pPalette->u8GetNbColors();
+    return (bNoColor && rStrip.bIsFaded()) ? SUBSTRIP_IDLE_FOREVER : 0;
+}
+
+/******************************************************************************/
+/* RAINDROPS                                                                  */
+/******************************************************************************/
+
+SubStrip::TeRetVal FxRaindrops::eInit(SubStrip &rStrip, TstState &rState) {
+    (void)rState;
+    rStrip.vScanActive();
+    rStrip._u8NbParticles = 0;
+    return SubStrip::RET_OK;
+}
+
+/*******************************************************************************
+ * @brief Manage raindrop animation
+ * @details Each trigger launches a drop from the start of the sub-strip (its
+ *          end in reverse), drops already falling go on.
+ ******************************************************************************/
+void FxRaindrops::vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick) {
+    if ((rState.u32Timeout < stTick.u32Now) && (rStrip._u32Period != SUBSTRIP_STOP_PERIODIC)) {
+        rState.u32Timeout = stTick.u32Now + rStrip._u32Period;
+        rStrip._bTrigger = true;
+    }
+    if (rStrip._pPalette == nullptr)
+    { return; }
+
+    rStrip.bFadeActive(stTick.u8Fade);
+
+    if (rStrip._bTrigger) {
+        rStrip._bTrigger = false;
+        if (rStrip._eDirection == SubStrip::REVERSE_OUTIN)
+        { rStrip.bSpawnParticle(((int32_t)rStrip._u16NbLeds - 1) << 8, -256, 0, 0); }
+        else
+        { rStrip.bSpawnParticle(0, 256, 0, 0); }
+    }
+    rStrip.vStepParticles(stTick.u16Steps);
+}
+
+/*******************************************************************************
+ * @brief Raindrops are static between the last faded drop and the next trigger
+ ******************************************************************************/
+uint32_t FxRaindrops::u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now) {
+    uint32_t u32Idle = 0;
+    if (rStrip._pPalette == nullptr)
+    { u32Idle = SUBSTRIP_IDLE_FOREVER; }
+    else if (!rStrip._bTrigger && rStrip.bIsFaded()) {
+        int32_t i32Next = (int32_t)(rState.u32Timeout - u32Now);
+        if (rStrip._u32Period == SUBSTRIP_STOP_PERIODIC)
+        { u32Idle = SUBSTRIP_IDLE_FOREVER; }
+        else if (i32Next > 0)
+        { u32Idle = (uint32_t)i32Next; }
+    }
+    return u32Idle;
+}
+
+/******************************************************************************/
+/* CHECKERED                                                                  */
+/******************************************************************************/
+
+/*******************************************************************************
+ * @brief Initialize checkered animation
+ * @details Pattern is rendered unrotated, the offset is applied at composition
+ ******************************************************************************/
+SubStrip::TeRetVal FxCheckered::eInit(SubStrip &rStrip, TstState &rState) {
+    (void)rState;
+    SubStrip::TeRetVal eRet = SubStrip::RET_OK;
+    if ((rStrip._pPalette == nullptr) || (!rStrip._pPalette->u8GetNbColors())){
+        _MNG_RETURN(SubStrip::RET_INTERNAL_ERROR);
+    }
+    else {
+        uint8_t u8NbColors = rStrip._pPalette->u8GetNbColors();
+        uint16_t u16Repeat = rStrip._u16NbLeds / u8NbColors;
+        u16Repeat = u16Repeat ? u16Repeat : 1;
+        CRGB* pLed = rStrip._SubLeds;
+        const CRGB* pFirst = rStrip._pPalette->pGetColors();
+        const CRGB* pColor = pFirst;
+
+        for (uint16_t i = 0; i < rStrip._u16NbLeds; i++) {
+            if ((i % u16Repeat == 0) && i) {
+                pColor++;
+                if ((pColor - pFirst) >= u8NbColors) {
+                    pColor = pFirst;
+                }
+            }
+            *pLed = *pColor;
+            pLed++;
+        }
+        rStrip._bDirty = true;
+    }
+    return eRet;
+}
+
+/*******************************************************************************
+ * @brief Manage chechered animation
+ ******************************************************************************/
+void FxCheckered::vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick) {
+    (void)rState;
+    for (uint16_t u16Steps = stTick.u16Steps; u16Steps; u16Steps--) {
+        if (rStrip._eDirection == SubStrip::FORWARD_INOUT)
+        { rStrip.vShiftFwd(nullptr); }
+        else
+        { rStrip.vShiftBwd(nullptr); }
+    }
+}
+
+uint32_t FxCheckered::u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now) {
+    (void)rStrip;
+    (void)rState;
+    (void)u32Now;
+    return 0; // rotates on every step
+}
+
+/******************************************************************************/
+/* WAVE                                                                       */
+/******************************************************************************/
+
+/*******************************************************************************
+ * @brief Initialize wave animation: cache the gradient, repaint on next step
+ * @details First to second color whatever the palette size, as the former
+ *          fill_gradient_RGB() call: not sampled from the palette table,
+ *          whose first segment ends before the second color with 3 or more.
+ ******************************************************************************/
+SubStrip::TeRetVal FxWave::eInit(SubStrip &rStrip, TstState &rState) {
+    rState.u8Width = (rStrip._u8Width < rStrip._u16NbLeds) ? rStrip._u8Width : rStrip._u16NbLeds;
+    rState.bPainted = false;
+    if (rStrip._pPalette && (rStrip._pPalette->u8GetNbColors() >= 2)) {
+        const CRGB *pColors = rStrip._pPalette->pGetColors();
+        fill_gradient_RGB(rState.tGradient, rState.u8Width, pColors[0], pColors[1]);
+    }
+    return SubStrip::RET_OK;
+}
+
+/*******************************************************************************
+ * @brief Manage wave animation
+ * @details Only the pixels between the previous and the new gradient window
+ *          are painted, nothing when the gradient did not move.
+ ******************************************************************************/
+void FxWave::vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick) {
+    if (rStrip._pPalette && (rStrip._pPalette->u8GetNbColors() >= 2)) {
+        const CRGB *pColors = rStrip._pPalette->pGetColors();
+        uint8_t u8Width = rState.u8Width;
+        uint16_t u16Pos = rStrip.u16BeatSin(stTick.u32Now, 0, rStrip._u16NbLeds - u8Width);
+        uint16_t u16From = 0;
+        uint16_t u16To = rStrip._u16NbLeds;
+
+        if (rState.bPainted) {
+            if (u16Pos == rState.u16Pos)
+            { return; } // unchanged, strip stays clean
+            u16From = (u16Pos < rState.u16Pos) ? u16Pos : rState.u16Pos;
+            u16To = ((u16Pos > rState.u16Pos) ? u16Pos : rState.u16Pos) + u8Width;
+        }
+        // [0, pos): palette[0], [pos, pos + width): gradient, [pos + width, n): palette[1]
+        vKernel_Fill(rStrip._SubLeds + u16From, u16Pos - u16From, pColors[0]);
+        memcpy(rStrip._SubLeds + u16Pos, rState.tGradient, u8Width * sizeof(CRGB));
+        vKernel_Fill(rStrip._SubLeds + u16Pos + u8Width, u16To - u16Pos - u8Width, pColors[1]);
+        rState.u16Pos = u16Pos;
+        rState.bPainted = true;
+        rStrip._bDirty = true;
+    }
+}
+
+uint32_t FxWave::u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now) {
+    (void)rState;
+    (void)u32Now;
+    bool bNoGradient = (rStrip._pPalette == nullptr) || (rStrip._pPalette->u8GetNbColors() < 2);
+    return bNoGradient ? SUBSTRIP_IDLE_FOREVER : 0;
+}
+
+/******************************************************************************/
+/* COMETS                                                                     */
+/******************************************************************************/
+
+SubStrip::TeRetVal FxComets::eInit(SubStrip &rStrip, TstState &rState) {
+    (void)rState;
+    rStrip.vScanActive();
+    rStrip._u8NbParticles = 0;
+    return SubStrip::RET_OK;
+}
+
+/*******************************************************************************
+ * @brief Manage comets animation
+ * @details Each period or trigger launches a comet from a random pixel, in a
+ *          random direction, at 1/4 to 1 pixel per step. Colors cycle through
+ *          the palette, the head dims along the way.
+ ******************************************************************************/
+void FxComets::vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick) {
+    if ((rState.u32Timeout < stTick.u32Now) && (rStrip._u32Period != SUBSTRIP_STOP_PERIODIC)) {
+        rState.u32Timeout = stTick.u32Now + rStrip._u32Period;
+        rStrip._bTrigger = true;
+    }
+    if (rStrip._pPalette == nullptr)
+    { return; }
+
+    rStrip.bFadeActive(stTick.u8Fade);
+
+    if (rStrip._bTrigger) {
+        rStrip._bTrigger = false;
+        uint16_t u16Rand = rStrip.u16Random();
+        int16_t i16Vel = 64 + (u16Rand & 0xC0); // 64..256
+        int32_t i32Pos = (int32_t)(rStrip.u16Random() % rStrip._u16NbLeds) << 8;
+        uint8_t u8Decay = 1 + ((u16Rand >> 8) & 3);
+        rStrip.bSpawnParticle(i32Pos, (u16Rand & 1) ? i16Vel : -i16Vel, rState.u8Color++, u8Decay);
+    }
+    rStrip.vStepParticles(stTick.u16Steps);
+}
+
+/*******************************************************************************
+ * @brief Comets are static between the last faded comet and the next launch
+ ******************************************************************************/
+uint32_t FxComets::u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now) {
+    uint32_t u32Idle = 0;
+    if (rStrip._pPalette == nullptr)
+    { u32Idle = SUBSTRIP_IDLE_FOREVER; }
+    else if (!rStrip._bTrigger && rStrip.bIsFaded()) {
+        int32_t i32Next = (int32_t)(rState.u32Timeout - u32Now);
+        if (rStrip._u32Period == SUBSTRIP_STOP_PERIODIC)
+        { u32Idle = SUBSTRIP_IDLE_FOREVER; }
+        else if (i32Next > 0)
+        { u32Idle = (uint32_t)i32Next; }
+    }
+    return u32Idle;
+}
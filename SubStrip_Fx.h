@@ -0,0 +1,92 @@
+/**
+ * @file SubStrip_Fx.h
+ * @brief Effects of the SubStrip animation registry.
+ * @author Nello
+ * @date 2025-10-14
+ */
+
+#ifndef _SUBSTRIP_FX_H
+#define _SUBSTRIP_FX_H
+
+#include "SubStrip.h"
+
+/*
+ * An effect is a type listed in FOREACH_SUBSTRIP_ANIM, made of:
+ *  - TstState: its private state, stored in the SubStrip effect slot
+ *    (at most SUBSTRIP_FX_STATE_SIZE bytes, zeroed before eInit)
+ *  - bRotate: the SubStrip offset is applied as a rotation when composed
+ *  - eInit(): called when the effect is selected and when the palette or the
+ *    width changes
+ *  - vStep(): called once per frame
+ *  - u32IdleMs(): time vStep() will leave the pixels unchanged for, 0 if it
+ *    may change them on the next frame, SUBSTRIP_IDLE_FOREVER if static
+ */
+typedef struct {
+    SubStrip::TeRetVal (*pfInit)(SubStrip &rStrip, void *pvState);
+    void (*pfStep)(SubStrip &rStrip, void *pvState, const SubStrip::TstTick &stTick);
+    uint32_t (*pfIdleMs)(SubStrip &rStrip, void *pvState, uint32_t u32Now);
+    const char *pcName;
+    bool bRotate;
+} TstSubStripFx;
+
+extern const TstSubStripFx tSubStripFx[SubStrip::NB_ANIMS];
+
+struct FxNone {
+    typedef struct {} TstState;
+    static const bool bRotate = false;
+    static SubStrip::TeRetVal eInit(SubStrip &rStrip, TstState &rState);
+    static void vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick);
+    static uint32_t u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now);
+};
+
+struct FxGlitter {
+    typedef struct {} TstState;
+    static const bool bRotate = false;
+    static SubStrip::TeRetVal eInit(SubStrip &rStrip, TstState &rState);
+    static void vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick);
+    static uint32_t u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now);
+};
+
+struct FxRaindrops {
+    typedef struct {
+        uint32_t u32Timeout; // next periodic trigger
+    } TstState;
+    static const bool bRotate = false;
+    static SubStrip::TeRetVal eInit(SubStrip &rStrip, TstState &rState);
+    static void vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick);
+    static uint32_t u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now);
+};
+
+struct FxCheckered {
+    typedef struct {} TstState;
+    static const bool bRotate = true;
+    static SubStrip::TeRetVal eInit(SubStrip &rStrip, TstState &rState);
+    static void vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick);
+    static uint32_t u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now);
+};
+
+struct FxWave {
+    typedef struct {
+        CRGB tGradient[SUBSTRIP_MAX_WIDTH]; // palette[0] -> palette[1]
+        uint8_t u8Width; // gradient width, clamped to the sub-strip
+        uint16_t u16Pos; // gradient position of the last frame
+        bool bPainted; // u16Pos is on the sub-strip
+    } TstState;
+    static const bool bRotate = false;
+    static SubStrip::TeRetVal eInit(SubStrip &rStrip, TstState &rState);
+    static void vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick);
+    static uint32_t u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now);
+};
+
+struct FxComets {
+    typedef struct {
+        uint32_t u32Timeout; // next periodic launch
+        uint8_t u8Color; // palette index of the next comet
+    } TstState;
+    static const bool bRotate = false;
+    static SubStrip::TeRetVal eInit(SubStrip &rStrip, TstState &rState);
+    static void vStep(SubStrip &rStrip, TstState &rState, const SubStrip::TstTick &stTick);
+    static uint32_t u32IdleMs(SubStrip &rStrip, TstState &rState, uint32_t u32Now);
+};
+
+#endif // _SUBSTRIP_FX_H
@@ -0,0 +1,101 @@
+/**
+ * @file Timeslot.cpp
+ * @brief Implementation of the Timeslot class.
+ * @author Nello
+ * @date 2025-12-22
+ */
+
+#include "Timeslot.h"
+#include <stdlib.h>
+
+#define _MNG_RETURN(x)  eRet = x
+
+/*******************************************************************************
+ * @brief Constructor for the Timeslot class, no range: always on
+ ******************************************************************************/
+Timeslot::Timeslot() {
+    vClear();
+}
+
+/*******************************************************************************
+ * @brief Add a working range
+ * @param pcOn start, "HH:MM" or "HH:MM:SS", seconds are ignored
+ * @param pcOff end, same format, excluded
+ ******************************************************************************/
+Timeslot::TeRetVal Timeslot::eAdd(const char *pcOn, const char *pcOff) {
+    TeRetVal eRet = RET_OK;
+    uint16_t u16On;
+    uint16_t u16Off;
+    if (!bParseMinute(pcOn, &u16On) || !bParseMinute(pcOff, &u16Off)) {
+        _MNG_RETURN(RET_BAD_PARAMETER);
+    }
+    else if (_u8NbSlots >= TIMESLOT_MAX) {
+        _MNG_RETURN(RET_GENERIC_ERROR);
+    }
+    else {
+        _tSlots[_u8NbSlots].u16On = u16On;
+        _tSlots[_u8NbSlots].u16Off = u16Off;
+        _u8NbSlots++;
+    }
+    return eRet;
+}
+
+void Timeslot::vClear(void) {
+    _u8NbSlots = 0;
+}
+
+/*******************************************************************************
+ * @brief Check if a minute of the day is within a working range
+ * @param u16Minute [0-TIMESLOT_DAY_MIN[ minute of the day
+ ******************************************************************************/
+bool Timeslot::bIsOn(uint16_t u16Minute) const {
+    bool bOn = !_u8NbSlots;
+    for (uint8_t i = 0; !bOn && (i < _u8NbSlots); i++) {
+        const TstSlot &rSlot = _tSlots[i];
+        if (rSlot.u16On == rSlot.u16Off)
+        { bOn = true; }
+        else if (rSlot.u16On < rSlot.u16Off)
+        { bOn = (u16Minute >= rSlot.u16On) && (u16Minute < rSlot.u16Off); }
+        else
+        { bOn = (u16Minute >= rSlot.u16On) || (u16Minute < rSlot.u16Off); } // crosses midnight
+    }
+    return bOn;
+}
+
+/*******************************************************************************
+ * @brief Minutes until the next range start or end
+ * @details The state may be the same after the edge when ranges overlap, the
+ *          caller checks bIsOn() again then.
+ * @param u16Minute [0-TIMESLOT_DAY_MIN[ minute of the day
+ * @return [1-TIMESLOT_DAY_MIN] minutes, TIMESLOT_DAY_MIN without any edge
+ ******************************************************************************/
+uint16_t Timeslot::u16MinutesToEdge(uint16_t u16Minute) const {
+    uint16_t u16Min = TIMESLOT_DAY_MIN;
+    for (uint8_t i = 0; i < _u8NbSlots; i++) {
+        uint16_t tu16Edges[2] = {_tSlots[i].u16On, _tSlots[i].u16Off};
+        for (uint8_t e = 0; e < 2; e++) {
+            uint16_t u16Dist = (tu16Edges[e] + TIMESLOT_DAY_MIN - u16Minute) % TIMESLOT_DAY_MIN;
+            u16Dist = u16Dist ? u16Dist : TIMESLOT_DAY_MIN;
+            u16Min = (u16Dist < u16Min) ? u16Dist : u16Min;
+        }
+    }
+    return u16Min;
+}
+
+/*******************************************************************************
+ * @brief Parse "HH:MM[:SS]" into a minute of the day
+ ******************************************************************************/
+bool Timeslot::bParseMinute(const char *pcTime, uint16_t *pu16Minute) {
+    char *pcEnd = nullptr;
+    if (pcTime == nullptr)
+    { return false; }
+    unsigned long ulHour = strtoul(pcTime, &pcEnd, 10);
+    if ((pcEnd == pcTime) || (*pcEnd != ':') || (ulHour > 23))
+    { return false; }
+    const char *pcMin = pcEnd + 1;
+    unsigned long ulMin = strtoul(pcMin, &pcEnd, 10);
+    if ((pcEnd == pcMin) || ((*pcEnd != ':') && (*pcEnd != '\0')) || (ulMin > 59))
+    { return false; }
+    *pu16Minute = (uint16_t)(ulHour * 60 + ulMin);
+    return true;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file Timeslot.h
+ * @brief Header file for the Timeslot class.
+ * @author Nello
+ * @date 2025-12-22
+ */
+
+#ifndef _TIMESLOT_H
+#define _TIMESLOT_H
+
+#include <stdint.h>
+
+#define TIMESLOT_MAX            8
+#define TIMESLOT_DAY_MIN        1440 // minutes per day
+
+/*
+ * Working hours of the device, as minute-of-day ranges parsed once from
+ * "HH:MM[:SS]" strings. A range whose OFF comes before its ON crosses
+ * midnight, ON equal to OFF covers the whole day. Without any range the
+ * device always works. The wall clock is given by the caller, the class
+ * has no time source of its own.
+ */
+class Timeslot {
+public:
+    typedef enum {
+        RET_OK                  = 0,
+        RET_GENERIC_ERROR       = -1,
+        RET_BAD_PARAMETER       = RET_GENERIC_ERROR - 1,
+    } TeRetVal;
+
+    Timeslot();
+    TeRetVal eAdd(const char *pcOn, const char *pcOff);
+    void vClear(void);
+    bool bIsOn(uint16_t u16Minute) const;
+    uint16_t u16MinutesToEdge(uint16_t u16Minute) const;
+
+    uint8_t u8GetNbSlots(void) const { return _u8NbSlots; }
+
+private:
+    typedef struct {
+        uint16_t u16On; // minute of day
+        uint16_t u16Off;
+    } TstSlot;
+
+    TstSlot _tSlots[TIMESLOT_MAX];
+    uint8_t _u8NbSlots;
+
+    static bool bParseMinute(const char *pcTime, uint16_t *pu16Minute);
+};
+
+#endif // _TIMESLOT_H
@@ -0,0 +1,185 @@
+/**
+ * @file Kernels_test.cpp
+ * @brief Host check of the pixel kernels against the FastLED scalar path.
+ * @author Nello
+ * @date 2026-01-20
+ *
+ * Every byte value is run through every fade, scale and blend amount, from
+ * each word alignment, and compared with the FastLED functions the kernels
+ * replace (test/host/FastLED.h). Then a short benchmark of both paths.
+ *
+ *   make -C test
+ */
+
+#include "Kernels.h"
+#include <stdio.h>
+#include <time.h>
+
+#define TEST_BYTES          (3 * 256 * 4) // every byte in each channel, 4 pixels apart
+#define TEST_PIXELS         (TEST_BYTES / 3)
+#define TEST_ALIGNMENTS     4
+#define TEST_BENCH_LEDS     300
+#define TEST_BENCH_LOOPS    20000
+
+static uint32_t u32Test_Failures = 0;
+
+static void vTest_Check(bool bOk, const char *pcWhat, uint32_t u32Arg) {
+    if (!bOk) {
+        if (u32Test_Failures < 10)
+        { printf("FAIL %s (%u)\n", pcWhat, u32Arg); }
+        u32Test_Failures++;
+    }
+}
+
+/*******************************************************************************
+ * @brief Pixels holding every byte value in every channel, from an offset
+ ******************************************************************************/
+static CRGB *pTest_Pattern(uint8_t *pu8Storage, uint8_t u8Align) {
+    CRGB *pLeds = (CRGB *)(pu8Storage + u8Align);
+    for (uint32_t i = 0; i < TEST_PIXELS; i++) {
+        pLeds[i] = CRGB((uint8_t)i, (uint8_t)(i * 7 + 1), (uint8_t)(255 - i));
+    }
+    return pLeds;
+}
+
+static void vTest_Fade(void) {
+    static uint8_t tu8Kernel[TEST_BYTES + TEST_ALIGNMENTS];
+    static CRGB tRef[TEST_PIXELS];
+    for (uint8_t u8Align = 0; u8Align < TEST_ALIGNMENTS; u8Align++) {
+        for (uint32_t u32Fade = 0; u32Fade < 256; u32Fade++) {
+            CRGB *pLeds = pTest_Pattern(tu8Kernel, u8Align);
+            memcpy(tRef, pLeds, sizeof(tRef));
+            bool bRefChanged = false;
+            for (uint32_t i = 0; i < TEST_PIXELS; i++) {
+                CRGB xPrev = tRef[i];
+                tRef[i].fadeToBlackBy((uint8_t)u32Fade);
+                bRefChanged |= (xPrev != tRef[i]);
+            }
+            bool bChanged = bKernel_Fade(pLeds, TEST_PIXELS, (uint8_t)u32Fade);
+            vTest_Check(!memcmp(pLeds, tRef, sizeof(tRef)), "bKernel_Fade", u32Fade);
+            vTest_Check(bChanged == bRefChanged, "bKernel_Fade changed", u32Fade);
+
+            pLeds = pTest_Pattern(tu8Kernel, u8Align);
+            memcpy(tRef, pLeds, sizeof(tRef));
+            for (uint32_t i = 0; i < TEST_PIXELS; i++)
+            { tRef[i].nscale8((uint8_t)u32Fade); }
+            vKernel_Scale(pLeds, TEST_PIXELS, (uint8_t)u32Fade);
+            vTest_Check(!memcmp(pLeds, tRef, sizeof(tRef)), "vKernel_Scale", u32Fade);
+        }
+    }
+}
+
+static void vTest_FadeSparse(void) {
+    static uint8_t tu8Kernel[TEST_BYTES];
+    static CRGB tRef[TEST_PIXELS];
+    static uint16_t tu16Index[TEST_PIXELS];
+    for (uint32_t u32Fade = 0; u32Fade < 256; u32Fade++) {
+        CRGB *pLeds = pTest_Pattern(tu8Kernel, 0);
+        uint16_t u16NbIndex = 0;
+        for (uint16_t i = 0; i < TEST_PIXELS; i += 3)
+        { tu16Index[u16NbIndex++] = i; } // one pixel in three
+        memcpy(tRef, pLeds, sizeof(tRef));
+        uint16_t u16RefKept = 0;
+        for (uint16_t k = 0; k < u16NbIndex; k++) {
+            tRef[tu16Index[k]].fadeToBlackBy((uint8_t)u32Fade);
+            u16RefKept += tRef[tu16Index[k]] ? 1 : 0;
+        }
+        bKernel_FadeSparse(pLeds, tu16Index, &u16NbIndex, (uint8_t)u32Fade);
+        vTest_Check(!memcmp(pLeds, tRef, sizeof(tRef)), "bKernel_FadeSparse", u32Fade);
+        vTest_Check(u16NbIndex == (u32Fade ? u16RefKept : TEST_PIXELS / 3 + 1), "bKernel_FadeSparse list", u32Fade);
+        for (uint16_t k = 0; k < u16NbIndex; k++)
+        { vTest_Check(u32Fade ? (bool)pLeds[tu16Index[k]] : true, "bKernel_FadeSparse black kept", u32Fade); }
+    }
+}
+
+static void vTest_Fill(void) {
+    static uint8_t tu8Kernel[TEST_BYTES + TEST_ALIGNMENTS];
+    static CRGB tRef[64];
+    const CRGB xColor(0x12, 0xA5, 0xFE);
+    for (uint8_t u8Align = 0; u8Align < TEST_ALIGNMENTS; u8Align++) {
+        for (uint16_t u16Len = 0; u16Len <= 64; u16Len++) {
+            memset(tu8Kernel, 0x5A, sizeof(tu8Kernel));
+            CRGB *pLeds = (CRGB *)(tu8Kernel + u8Align);
+            memcpy(tRef, pLeds, sizeof(tRef));
+            fill_solid(tRef, u16Len, xColor);
+            vKernel_Fill(pLeds, u16Len, xColor);
+            vTest_Check(!memcmp(pLeds, tRef, sizeof(tRef)), "vKernel_Fill", u16Len);
+        }
+    }
+}
+
+static void vTest_BlendPixel(void) {
+    // every (below, above, amount) triple, one per channel combination
+    for (uint32_t u32Amount = 0; u32Amount < 256; u32Amount++) {
+        for (uint32_t u32A = 0; u32A < 256; u32A++) {
+            for (uint32_t u32B = 0; u32B < 256; u32B++) {
+                CRGB xA((uint8_t)u32A, (uint8_t)u32B, (uint8_t)(u32A ^ u32B));
+                CRGB xB((uint8_t)u32B, (uint8_t)u32A, (uint8_t)(255 - u32B));
+                CRGB xRef = blend(xA, xB, (uint8_t)u32Amount);
+                CRGB xMix = xKernel_BlendPixel(xA, xB, (uint8_t)u32Amount);
+                vTest_Check(xMix == xRef, "xKernel_BlendPixel", u32Amount);
+            }
+        }
+    }
+}
+
+static double dTest_Seconds(void) {
+    struct timespec stNow;
+    clock_gettime(CLOCK_MONOTONIC, &stNow);
+    return stNow.tv_sec + stNow.tv_nsec * 1e-9;
+}
+
+static void vTest_Bench(void) {
+    static CRGB tLeds[TEST_BENCH_LEDS];
+    static CRGB tOverlay[TEST_BENCH_LEDS];
+    volatile uint8_t u8Sink = 0;
+    for (uint16_t i = 0; i < TEST_BENCH_LEDS; i++) {
+        tOverlay[i] = CRGB((uint8_t)i, (uint8_t)(i * 3), (uint8_t)(i * 5));
+    }
+
+    double dStart = dTest_Seconds();
+    for (uint32_t n = 0; n < TEST_BENCH_LOOPS; n++) {
+        memcpy(tLeds, tOverlay, sizeof(tLeds));
+        for (uint16_t i = 0; i < TEST_BENCH_LEDS; i++)
+        { tLeds[i].fadeToBlackBy(32); }
+        u8Sink += tLeds[n % TEST_BENCH_LEDS].r;
+    }
+    double dScalar = dTest_Seconds() - dStart;
+    dStart = dTest_Seconds();
+    for (uint32_t n = 0; n < TEST_BENCH_LOOPS; n++) {
+        memcpy(tLeds, tOverlay, sizeof(tLeds));
+        bKernel_Fade(tLeds, TEST_BENCH_LEDS, 32);
+        u8Sink += tLeds[n % TEST_BENCH_LEDS].r;
+    }
+    double dKernel = dTest_Seconds() - dStart;
+    printf("fade  %u leds: scalar %.1f ns/led, kernel %.1f ns/led\n", TEST_BENCH_LEDS,
+        dScalar * 1e9 / (TEST_BENCH_LOOPS * TEST_BENCH_LEDS), dKernel * 1e9 / (TEST_BENCH_LOOPS * TEST_BENCH_LEDS));
+
+    dStart = dTest_Seconds();
+    for (uint32_t n = 0; n < TEST_BENCH_LOOPS; n++) {
+        for (uint16_t i = 0; i < TEST_BENCH_LEDS; i++)
+        { tLeds[i] = blend(tLeds[i], tOverlay[i], (uint8_t)n); }
+        u8Sink += tLeds[n % TEST_BENCH_LEDS].g;
+    }
+    dScalar = dTest_Seconds() - dStart;
+    dStart = dTest_Seconds();
+    for (uint32_t n = 0; n < TEST_BENCH_LOOPS; n++) {
+        for (uint16_t i = 0; i < TEST_BENCH_LEDS; i++)
+        { tLeds[i] = xKernel_BlendPixel(tLeds[i], tOverlay[i], (uint8_t)n); }
+        u8Sink += tLeds[n % TEST_BENCH_LEDS].g;
+    }
+    dKernel = dTest_Seconds() - dStart;
+    printf("blend %u leds: scalar %.1f ns/led, kernel %.1f ns/led\n", TEST_BENCH_LEDS,
+        dScalar * 1e9 / (TEST_BENCH_LOOPS * TEST_BENCH_LEDS), dKernel * 1e9 / (TEST_BENCH_LOOPS * TEST_BENCH_LEDS));
+    (void)u8Sink;
+}
+
+int main(void) {
+    vTest_Fade();
+    vTest_FadeSparse();
+    vTest_Fill();
+    vTest_BlendPixel();
+    printf("kernels (KERNEL_SWAR %d, KERNEL_SWAR_BLEND %d, KERNEL_PIE %d): %s, %u failure(s)\n", KERNEL_SWAR, KERNEL_SWAR_BLEND, KERNEL_PIE, u32Test_Failures ? "FAIL" : "ok", u32Test_Failures);
+    vTest_Bench();
+    return u32Test_Failures ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file LedOutput_test.cpp
+ * @brief Host check of the output wire time model.
+ * @author Nello
+ * @date 2026-01-26
+ *
+ * Frame rate limit of several port layouts: ports are sent in parallel, the
+ * longest one sets the pace, one WS2812 pixel is 30 us on the wire plus the
+ * 50 us latch. Rejected layouts leave the previous one in place.
+ *
+ *   make -C test
+ */
+
+#include "LedOutput.h"
+#include <stdio.h>
+
+static uint32_t u32Test_Failures = 0;
+
+static void vTest_Check(bool bOk, const char *pcWhat, uint32_t u32Arg) {
+    if (!bOk) {
+        if (u32Test_Failures < 10)
+        { printf("FAIL %s (%u)\n", pcWhat, u32Arg); }
+        u32Test_Failures++;
+    }
+}
+
+typedef struct {
+    const char *pcName;
+    uint8_t u8NbPorts;
+    TstLedOutput_Port tstPorts[LED_OUTPUT_MAX];
+    uint32_t u32WireUs;
+    uint16_t u16MaxFps;
+} TstTest_Layout;
+
+static const TstTest_Layout tstTest_Layouts[] = {
+    {"1 led",           1, {{2, 1}},                                        80,     12500},
+    {"300 leds",        1, {{2, 300}},                                      9050,   110},
+    {"1000 leds",       1, {{2, 1000}},                                     30050,  33},
+    {"1000 leds / 2",   2, {{2, 500}, {4, 500}},                            15050,  66},
+    {"1000 leds / 4",   4, {{2, 250}, {4, 250}, {5, 250}, {18, 250}},       7550,   132},
+    {"uneven / 4",      4, {{2, 100}, {4, 300}, {5, 300}, {18, 300}},       9050,   110},
+    {"1000 leds / 8",   8, {{2, 125}, {4, 125}, {5, 125}, {18, 125},
+                            {19, 125}, {21, 125}, {22, 125}, {23, 125}},    3800,   263},
+    {"2048 leds / 8",   8, {{2, 256}, {4, 256}, {5, 256}, {18, 256},
+                            {19, 256}, {21, 256}, {22, 256}, {23, 256}},    7730,   129},
+};
+
+static void vTest_Layouts(void) {
+    const TstLedOutput_Port *pstPorts = nullptr;
+    vTest_Check(u32LedOutput_GetWireUs() == 0, "no layout, wire time", u32LedOutput_GetWireUs());
+    vTest_Check(u16LedOutput_GetMaxFps() == 0, "no layout, max fps", u16LedOutput_GetMaxFps());
+    vTest_Check(u8LedOutput_GetPorts(&pstPorts) == 0, "no layout, ports", 0);
+
+    for (uint8_t i = 0; i < ARRAY_SIZEOF(tstTest_Layouts); i++) {
+        const TstTest_Layout *pstLayout = &tstTest_Layouts[i];
+        eApp_RetVal eRet = eLedOutput_SetLayout(pstLayout->tstPorts, pstLayout->u8NbPorts);
+        vTest_Check(eRet == eRet_Ok, pstLayout->pcName, (uint32_t)eRet);
+        vTest_Check(u32LedOutput_GetWireUs() == pstLayout->u32WireUs, pstLayout->pcName, u32LedOutput_GetWireUs());
+        vTest_Check(u16LedOutput_GetMaxFps() == pstLayout->u16MaxFps, pstLayout->pcName, u16LedOutput_GetMaxFps());
+        vTest_Check(u8LedOutput_GetPorts(&pstPorts) == pstLayout->u8NbPorts, pstLayout->pcName, pstLayout->u8NbPorts);
+        for (uint8_t p = 0; p < pstLayout->u8NbPorts; p++) {
+            vTest_Check(bLedOutput_IsValidPin(pstPorts[p].u8Pin), pstLayout->pcName, pstPorts[p].u8Pin);
+            vTest_Check(pstPorts[p].u16NbLeds == pstLayout->tstPorts[p].u16NbLeds, pstLayout->pcName, p);
+        }
+        printf("%-16s %u port(s): %5u us/frame, %5u fps max\n", pstLayout->pcName, pstLayout->u8NbPorts,
+            u32LedOutput_GetWireUs(), u16LedOutput_GetMaxFps());
+    }
+}
+
+static void vTest_Rejected(void) {
+    TstLedOutput_Port tstPorts[LED_OUTPUT_MAX + 1];
+    const TstLedOutput_Port *pstPorts = nullptr;
+    for (uint8_t i = 0; i <= LED_OUTPUT_MAX; i++) {
+        tstPorts[i].u8Pin = 2;
+        tstPorts[i].u16NbLeds = 10;
+    }
+    tstPorts[0].u16NbLeds = 300;
+    eLedOutput_SetLayout(tstPorts, 1);
+
+    vTest_Check(eLedOutput_SetLayout(nullptr, 1) == eRet_BadParameter, "no ports", 0);
+    vTest_Check(eLedOutput_SetLayout(tstPorts, 0) == eRet_BadParameter, "0 port", 0);
+    vTest_Check(eLedOutput_SetLayout(tstPorts, LED_OUTPUT_MAX + 1) == eRet_BadParameter, "too many ports", LED_OUTPUT_MAX + 1);
+    vTest_Check(u32LedOutput_GetWireUs() == LED_OUTPUT_WIRE_US(300), "layout kept", u32LedOutput_GetWireUs());
+    vTest_Check(u8LedOutput_GetPorts(&pstPorts) == 1, "ports kept", 0);
+
+    vTest_Check(!bLedOutput_IsValidPin(0), "pin 0", 0);
+    vTest_Check(!bLedOutput_IsValidPin(3), "pin 3", 3);
+    vTest_Check(!bLedOutput_IsValidPin(255), "pin 255", 255);
+}
+
+int main(void) {
+    vTest_Layouts();
+    vTest_Rejected();
+    printf("led output: %s, %u failure(s)\n", u32Test_Failures ? "FAIL" : "ok", u32Test_Failures);
+    return u32Test_Failures ? 1 : 0;
+}
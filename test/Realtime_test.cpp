@@ -0,0 +1,296 @@
+/**
+ * @file Realtime_test.cpp
+ * @brief Host loopback check of the realtime input.
+ * @author Nello
+ * @date 2026-01-26
+ *
+ * A sender socket on 127.0.0.1 plays a lighting desk: DDP frames with and
+ * without push, clamped and out of range offsets, packets shorter than their
+ * header announces, E1.31 universes with and without sync, stale sequences,
+ * priorities and stream termination. Frame bytes and reported ranges are
+ * checked after each frame.
+ *
+ *   make -C test
+ */
+
+#include "Realtime.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#define TEST_DDP_PORT       14048 // away from the real ones
+#define TEST_E131_PORT      15568
+#define TEST_FRAME_BYTES    (300 * 3)
+#define TEST_WAIT_MS        100
+#define TEST_SENTINEL       0xA5
+
+static uint32_t u32Test_Failures = 0;
+static int iTest_Tx = -1;
+static uint8_t tu8Test_Frame[TEST_FRAME_BYTES];
+static uint8_t tu8Test_Packet[1500];
+
+static void vTest_Check(bool bOk, const char *pcWhat, uint32_t u32Arg) {
+    if (!bOk) {
+        if (u32Test_Failures < 10)
+        { printf("FAIL %s (%u)\n", pcWhat, u32Arg); }
+        u32Test_Failures++;
+    }
+}
+
+static uint32_t u32Test_Now(void) {
+    struct timespec stNow;
+    clock_gettime(CLOCK_MONOTONIC, &stNow);
+    return (uint32_t)(stNow.tv_sec * 1000 + stNow.tv_nsec / 1000000);
+}
+
+static void vTest_Send(int iSocket, uint16_t u16Port, int iLength) {
+    struct sockaddr_in stTo;
+    memset(&stTo, 0, sizeof(stTo));
+    stTo.sin_family = AF_INET;
+    stTo.sin_port = htons(u16Port);
+    stTo.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sendto(iSocket, tu8Test_Packet, iLength, 0, (struct sockaddr *)&stTo, sizeof(stTo));
+}
+
+/*******************************************************************************
+ * @brief DDP RGB packet, u16Length announced, u16Sent payload bytes sent
+ ******************************************************************************/
+static int iTest_Ddp(uint32_t u32Offset, uint16_t u16Length, uint16_t u16Sent, uint8_t u8Value, bool bPush) {
+    uint8_t *pu8 = tu8Test_Packet;
+    pu8[0] = 0x40 | (bPush ? 0x01 : 0x00);
+    pu8[1] = 1;
+    pu8[2] = 0x0B; // RGB, 8 bit
+    pu8[3] = 1;
+    pu8[4] = u32Offset >> 24;
+    pu8[5] = u32Offset >> 16;
+    pu8[6] = u32Offset >> 8;
+    pu8[7] = u32Offset;
+    pu8[8] = u16Length >> 8;
+    pu8[9] = u16Length;
+    memset(pu8 + 10, u8Value, u16Sent);
+    return 10 + u16Sent;
+}
+
+/*******************************************************************************
+ * @brief E1.31 data packet, u16Count channels announced, u16Sent sent
+ ******************************************************************************/
+static int iTest_E131(uint16_t u16Universe, uint8_t u8Seq, uint8_t u8Priority, uint16_t u16Sync,
+                      uint16_t u16Count, uint16_t u16Sent, uint8_t u8Value, uint8_t u8Options) {
+    uint8_t *pu8 = tu8Test_Packet;
+    memset(pu8, 0, 126);
+    pu8[1] = 0x10;
+    memcpy(pu8 + 4, "ASC-E1.17\0\0\0", 12);
+    pu8[21] = 0x04; // root: data
+    pu8[43] = 0x02; // framing: data
+    pu8[108] = u8Priority;
+    pu8[109] = u16Sync >> 8;
+    pu8[110] = u16Sync;
+    pu8[111] = u8Seq;
+    pu8[112] = u8Options;
+    pu8[113] = u16Universe >> 8;
+    pu8[114] = u16Universe;
+    pu8[117] = 0x02;
+    pu8[118] = 0xA1;
+    pu8[122] = 1;
+    pu8[123] = (u16Count + 1) >> 8;
+    pu8[124] = u16Count + 1;
+    memset(pu8 + 126, u8Value, u16Sent);
+    return 126 + u16Sent;
+}
+
+static int iTest_Sync(uint16_t u16Sync, uint8_t u8Seq) {
+    uint8_t *pu8 = tu8Test_Packet;
+    memset(pu8, 0, 49);
+    pu8[1] = 0x10;
+    memcpy(pu8 + 4, "ASC-E1.17\0\0\0", 12);
+    pu8[21] = 0x08; // root: extended
+    pu8[43] = 0x01; // framing: sync
+    pu8[44] = u8Seq;
+    pu8[45] = u16Sync >> 8;
+    pu8[46] = u16Sync;
+    return 49;
+}
+
+/*******************************************************************************
+ * @brief Receive until a frame completes or nothing comes
+ * @return number of packets handled before the frame, -1 without a frame
+ ******************************************************************************/
+static int iTest_WaitFrame(Realtime &rRt) {
+    int iPackets = 0;
+    for (uint8_t i = 0; i < 16; i++) {
+        Realtime::TeEvent eEvent = rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+        if (eEvent == Realtime::EVENT_FRAME)
+        { return iPackets; }
+        if (eEvent == Realtime::EVENT_NONE)
+        { return -1; }
+        iPackets++;
+    }
+    return -1;
+}
+
+static bool bTest_Range(const Realtime &rRt, uint8_t u8Index, uint32_t u32Offset, uint32_t u32Length) {
+    const Realtime::TstRange *pstRanges;
+    uint8_t u8NbRanges = rRt.u8GetFrameRanges(&pstRanges);
+    return (u8Index < u8NbRanges) && (pstRanges[u8Index].u32Offset == u32Offset) && (pstRanges[u8Index].u32Length == u32Length);
+}
+
+static uint8_t u8Test_NbRanges(const Realtime &rRt) {
+    const Realtime::TstRange *pstRanges;
+    return rRt.u8GetFrameRanges(&pstRanges);
+}
+
+static void vTest_Ddp(Realtime &rRt) {
+    const Realtime::TstCounters &rCnt = rRt.stGetCounters();
+
+    // two payloads, the push completes the frame
+    memset(tu8Test_Frame, TEST_SENTINEL, sizeof(tu8Test_Frame));
+    vTest_Send(iTest_Tx, TEST_DDP_PORT, iTest_Ddp(0, 450, 450, 1, false));
+    vTest_Send(iTest_Tx, TEST_DDP_PORT, iTest_Ddp(450, 450, 450, 2, true));
+    vTest_Check(iTest_WaitFrame(rRt) == 1, "ddp push", 0);
+    vTest_Check((tu8Test_Frame[449] == 1) && (tu8Test_Frame[450] == 2) && (tu8Test_Frame[899] == 2), "ddp bytes", 0);
+    vTest_Check((u8Test_NbRanges(rRt) == 1) && bTest_Range(rRt, 0, 0, TEST_FRAME_BYTES), "ddp ranges merged", u8Test_NbRanges(rRt));
+
+    // past the end: clamped to the frame, then out of range
+    memset(tu8Test_Frame, TEST_SENTINEL, sizeof(tu8Test_Frame));
+    vTest_Send(iTest_Tx, TEST_DDP_PORT, iTest_Ddp(TEST_FRAME_BYTES, 10, 10, 3, true));
+    vTest_Send(iTest_Tx, TEST_DDP_PORT, iTest_Ddp(800, 200, 200, 3, true));
+    vTest_Check(iTest_WaitFrame(rRt) == 1, "ddp clamp", 0);
+    vTest_Check(bTest_Range(rRt, 0, 800, 100) && (tu8Test_Frame[899] == 3), "ddp clamp range", 0);
+    vTest_Check(rCnt.tu32Drops[Realtime::DROP_RANGE] == 1, "ddp range drop", rCnt.tu32Drops[Realtime::DROP_RANGE]);
+
+    // shorter than announced: only what came is reported, counted malformed
+    memset(tu8Test_Frame, TEST_SENTINEL, sizeof(tu8Test_Frame));
+    uint32_t u32Malformed = rCnt.tu32Drops[Realtime::DROP_MALFORMED];
+    uint32_t u32Packets = rCnt.u32Packets;
+    vTest_Send(iTest_Tx, TEST_DDP_PORT, iTest_Ddp(300, 300, 90, 4, true));
+    vTest_Check(iTest_WaitFrame(rRt) == 0, "ddp short", 0);
+    vTest_Check((u8Test_NbRanges(rRt) == 1) && bTest_Range(rRt, 0, 300, 90), "ddp short range", u8Test_NbRanges(rRt));
+    vTest_Check((tu8Test_Frame[389] == 4) && (tu8Test_Frame[390] == TEST_SENTINEL), "ddp short bytes", tu8Test_Frame[390]);
+    vTest_Check(rCnt.tu32Drops[Realtime::DROP_MALFORMED] == (u32Malformed + 1), "ddp short malformed", rCnt.tu32Drops[Realtime::DROP_MALFORMED]);
+    vTest_Check(rCnt.u32Packets == u32Packets, "ddp short not a packet", rCnt.u32Packets);
+
+    // header alone
+    vTest_Send(iTest_Tx, TEST_DDP_PORT, iTest_Ddp(0, 30, 0, 5, true));
+    vTest_Check(iTest_WaitFrame(rRt) == 0, "ddp empty", 0);
+    vTest_Check(u8Test_NbRanges(rRt) == 0, "ddp empty ranges", u8Test_NbRanges(rRt));
+
+    // no push: rewriting the frame start completes the frame, the packet stays queued
+    vTest_Send(iTest_Tx, TEST_DDP_PORT, iTest_Ddp(0, 30, 30, 6, false));
+    vTest_Send(iTest_Tx, TEST_DDP_PORT, iTest_Ddp(0, 30, 30, 7, false));
+    vTest_Check(iTest_WaitFrame(rRt) == 1, "ddp no push", 0);
+    vTest_Check(tu8Test_Frame[0] == 6, "ddp no push bytes", tu8Test_Frame[0]);
+    vTest_Check(rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS) == Realtime::EVENT_PACKET, "ddp queued", 0);
+    vTest_Check(tu8Test_Frame[0] == 7, "ddp queued bytes", tu8Test_Frame[0]);
+
+    // a header too short for DDP
+    u32Malformed = rCnt.tu32Drops[Realtime::DROP_MALFORMED];
+    vTest_Send(iTest_Tx, TEST_DDP_PORT, 3);
+    rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+    vTest_Check(rCnt.tu32Drops[Realtime::DROP_MALFORMED] == (u32Malformed + 1), "ddp truncated header", 0);
+    rRt.vRelease();
+}
+
+static void vTest_E131(Realtime &rRt) {
+    const Realtime::TstCounters &rCnt = rRt.stGetCounters();
+
+    // both universes of the frame, no sync
+    memset(tu8Test_Frame, TEST_SENTINEL, sizeof(tu8Test_Frame));
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(1, 10, 100, 0, 510, 510, 8, 0));
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(2, 10, 100, 0, 390, 390, 9, 0));
+    vTest_Check(iTest_WaitFrame(rRt) == 1, "e131 universes", 0);
+    vTest_Check((tu8Test_Frame[509] == 8) && (tu8Test_Frame[510] == 9) && (tu8Test_Frame[899] == 9), "e131 bytes", 0);
+    vTest_Check(bTest_Range(rRt, 0, 0, TEST_FRAME_BYTES), "e131 ranges", 0);
+
+    // older sequence
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(1, 5, 100, 0, 510, 510, 8, 0));
+    rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+    vTest_Check(rCnt.tu32Drops[Realtime::DROP_SEQUENCE] == 1, "e131 sequence", rCnt.tu32Drops[Realtime::DROP_SEQUENCE]);
+
+    // synchronized: the frame waits for the sync packet
+    uint32_t u32Syncs = rCnt.u32Syncs;
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(1, 11, 100, 7, 510, 510, 10, 0));
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(2, 11, 100, 7, 390, 390, 11, 0));
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_Sync(7, 1));
+    vTest_Check(iTest_WaitFrame(rRt) == 2, "e131 sync", 0);
+    vTest_Check(rCnt.u32Syncs == (u32Syncs + 1), "e131 sync count", rCnt.u32Syncs);
+    vTest_Check((tu8Test_Frame[0] == 10) && (tu8Test_Frame[899] == 11), "e131 sync bytes", 0);
+
+    // shorter than its channel count
+    memset(tu8Test_Frame, TEST_SENTINEL, sizeof(tu8Test_Frame));
+    uint32_t u32Malformed = rCnt.tu32Drops[Realtime::DROP_MALFORMED];
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(1, 12, 100, 9, 510, 120, 12, 0));
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_Sync(9, 2));
+    vTest_Check(iTest_WaitFrame(rRt) == 1, "e131 short", 0);
+    vTest_Check((u8Test_NbRanges(rRt) == 1) && bTest_Range(rRt, 0, 0, 120), "e131 short range", u8Test_NbRanges(rRt));
+    vTest_Check((tu8Test_Frame[119] == 12) && (tu8Test_Frame[120] == TEST_SENTINEL), "e131 short bytes", tu8Test_Frame[120]);
+    vTest_Check(rCnt.tu32Drops[Realtime::DROP_MALFORMED] == (u32Malformed + 1), "e131 short malformed", 0);
+
+    // lower priority from the owner's address is the owner: priority drops
+    // need another source, preview and out of range universes are dropped
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(1, 13, 100, 0, 510, 510, 13, 0x80));
+    rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+    vTest_Check(rCnt.tu32Drops[Realtime::DROP_PREVIEW] == 1, "e131 preview", rCnt.tu32Drops[Realtime::DROP_PREVIEW]);
+    uint32_t u32Range = rCnt.tu32Drops[Realtime::DROP_RANGE];
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(40, 13, 100, 0, 510, 510, 13, 0));
+    rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+    vTest_Check(rCnt.tu32Drops[Realtime::DROP_RANGE] == (u32Range + 1), "e131 universe range", 0);
+
+    // the source leaves
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(1, 14, 100, 0, 510, 510, 14, 0x40));
+    rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+    vTest_Check(!rRt.bIsActive(u32Test_Now()), "e131 terminated", 0);
+}
+
+static void vTest_Owner(Realtime &rRt) {
+    const Realtime::TstCounters &rCnt = rRt.stGetCounters();
+    int iOther = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in stFrom;
+    memset(&stFrom, 0, sizeof(stFrom));
+    stFrom.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.2", &stFrom.sin_addr);
+    if ((iOther < 0) || (bind(iOther, (struct sockaddr *)&stFrom, sizeof(stFrom)) < 0)) {
+        printf("skip owner: no 127.0.0.2\n");
+        if (iOther >= 0)
+        { close(iOther); }
+        return;
+    }
+
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(1, 20, 100, 0, 510, 510, 20, 0));
+    rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+    vTest_Check(rRt.bIsActive(u32Test_Now()), "owner", 0);
+    // lower or same priority elsewhere: dropped; higher: takes over
+    vTest_Send(iOther, TEST_E131_PORT, iTest_E131(1, 1, 100, 0, 510, 510, 21, 0));
+    rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+    vTest_Check(rCnt.tu32Drops[Realtime::DROP_PRIORITY] == 1, "owner priority", rCnt.tu32Drops[Realtime::DROP_PRIORITY]);
+    vTest_Send(iOther, TEST_E131_PORT, iTest_E131(1, 2, 150, 0, 510, 510, 22, 0));
+    rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+    vTest_Check(tu8Test_Frame[0] == 22, "owner taken over", tu8Test_Frame[0]);
+    vTest_Send(iTest_Tx, TEST_E131_PORT, iTest_E131(1, 21, 100, 0, 510, 510, 23, 0));
+    rRt.eReceive(tu8Test_Frame, u32Test_Now(), TEST_WAIT_MS);
+    vTest_Check(rCnt.tu32Drops[Realtime::DROP_PRIORITY] == 2, "former owner", rCnt.tu32Drops[Realtime::DROP_PRIORITY]);
+    // silence: lost after the timeout
+    vTest_Check(!rRt.bIsActive(u32Test_Now() + REALTIME_TIMEOUT_MS + 1), "owner timeout", 0);
+    close(iOther);
+}
+
+int main(void) {
+    Realtime xRt;
+    iTest_Tx = socket(AF_INET, SOCK_DGRAM, 0);
+    vTest_Check(xRt.eConfigure(TEST_DDP_PORT, TEST_E131_PORT, 1, TEST_FRAME_BYTES) == Realtime::RET_OK, "configure", 0);
+    vTest_Check(xRt.eOpen() == Realtime::RET_OK, "open", 0);
+    if ((iTest_Tx < 0) || u32Test_Failures) {
+        printf("realtime: no loopback socket\n");
+        return 1;
+    }
+    vTest_Ddp(xRt);
+    vTest_E131(xRt);
+    vTest_Owner(xRt);
+    xRt.vClose();
+    close(iTest_Tx);
+    printf("realtime: %s, %u failure(s)\n", u32Test_Failures ? "FAIL" : "ok", u32Test_Failures);
+    return u32Test_Failures ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file SubStrip_bench.cpp
+ * @brief Host render benchmark of the SubStrip animations.
+ * @author Nello
+ * @date 2026-01-26
+ *
+ * Same tables and output as App_Bench on the device, so both feed the same
+ * tooling: every animation, for each length and speed, on a scratch
+ * sub-strip. SubStrip takes the time as a parameter: the animation clock is a
+ * synthetic one, BENCH_FRAME_MS per frame, and only the measure uses the
+ * wall clock. One JSON object per line:
+ * {"anim":"wave","len":100,"speed":1,"frames":200,"ns_frame":1234,"ns_led":12.34,"bytes_frame":600}
+ *  - ns_frame: vManageAnimation() + eGetSubStrip(), averaged
+ *  - ns_led: ns_frame per LED, with decimals: a host is fast
+ *  - bytes_frame: pixel bytes changed by the effect plus the composition
+ *    copy (read + write) of dirty frames, averaged
+ * Then the rotation of CHECKERED (speed 1: one step per frame) against the
+ * former pixel shift it replaced, transcribed below, at BENCH_ROTATE_LENGTHS:
+ * {"rotate":"head","len":200,"frames":200,"ns_frame":123,"fps":8130081}
+ *  - head: the rotation head, applied by eGetSubStrip() while composing
+ *  - shift: every pixel moved one slot per step, then the plain copy
+ *  - fps: render-bound frames per second of the strip alone, wire time and
+ *    other strips not counted
+ *
+ *   make -C test bench [BENCH_ARGS=<frames>]
+ */
+
+#include "SubStrip.h"
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_FRAMES        200 // default frames per measure
+#define BENCH_FRAME_MS      20  // synthetic clock step, 50 fps
+#define BENCH_SEED          1   // same random stream on every run
+#define BENCH_MAX_LEN       1500 // longest of tu16Bench_Lengths
+#define ARRAY_SIZEOF(a)     (sizeof(a) / sizeof((a)[0]))
+
+static const uint16_t tu16Bench_Lengths[] = {10, 50, 100, 200, 600, 1000, 1500};
+static const uint8_t tu8Bench_Speeds[] = {1, 2, 4};
+static const CRGB tBench_Colors[] = {CRGB::Blue, CRGB::Red, CRGB::White};
+static const uint16_t tu16Bench_RotateLengths[] = {20, 200, 1000};
+
+static uint64_t u64Bench_Ns(void) {
+    struct timespec stNow;
+    clock_gettime(CLOCK_MONOTONIC, &stNow);
+    return (uint64_t)stNow.tv_sec * 1000000000ULL + stNow.tv_nsec;
+}
+
+/*******************************************************************************
+ * @brief Former SubStrip::vShiftFwd(), pixels moved one slot forward
+ ******************************************************************************/
+static void vBench_ShiftFwd(CRGB *pLeds, uint16_t u16NbLeds) {
+    CRGB xLast = pLeds[u16NbLeds - 1];
+    CRGB *pPixel = pLeds + u16NbLeds - 1;
+    for (uint16_t i = 0; i < u16NbLeds - 1; i++) {
+        *pPixel = *(pPixel - 1);
+        pPixel--;
+    }
+    pLeds[0] = xLast;
+}
+
+static void vBench_Print(const char *pcRotate, uint16_t u16Len, uint16_t u16Frames, uint64_t u64Elapsed) {
+    uint64_t u64Frame = u64Elapsed / u16Frames;
+    printf("{\"rotate\":\"%s\",\"len\":%u,\"frames\":%u,\"ns_frame\":%u,\"fps\":%u}\n",
+        pcRotate, u16Len, u16Frames, (uint32_t)u64Frame, (uint32_t)(1000000000ULL / (u64Frame ? u64Frame : 1)));
+}
+
+/*******************************************************************************
+ * @brief Rotation head against the former pixel shift, CHECKERED
+ ******************************************************************************/
+static void vBench_Rotate(uint16_t u16Frames, CRGB *pLeds, CRGB *pOut, Palette *pPalette) {
+    for (uint8_t l = 0; l < ARRAY_SIZEOF(tu16Bench_RotateLengths); l++) {
+        uint16_t u16Len = tu16Bench_RotateLengths[l];
+        uint32_t u32Now = 0;
+        uint64_t u64Elapsed = 0;
+        SubStrip xStrip(u16Len, pLeds);
+        xStrip.eSetAnimation(SubStrip::CHECKERED, pPalette, 1000, 1);
+        xStrip.vManageAnimation(u32Now);
+        for (uint16_t f = 0; f < u16Frames; f++) {
+            u32Now += BENCH_FRAME_MS;
+            uint64_t u64Start = u64Bench_Ns();
+            xStrip.vManageAnimation(u32Now);
+            xStrip.eGetSubStrip(pOut, u16Len);
+            u64Elapsed += u64Bench_Ns() - u64Start;
+        }
+        vBench_Print("head", u16Len, u16Frames, u64Elapsed);
+
+        u64Elapsed = 0;
+        for (uint16_t f = 0; f < u16Frames; f++) {
+            uint64_t u64Start = u64Bench_Ns();
+            vBench_ShiftFwd(pLeds, u16Len);
+            memcpy((void *)pOut, pLeds, u16Len * sizeof(CRGB));
+            u64Elapsed += u64Bench_Ns() - u64Start;
+        }
+        vBench_Print("shift", u16Len, u16Frames, u64Elapsed);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint16_t u16Frames = (argc > 1) ? (uint16_t)atoi(argv[1]) : 0;
+    u16Frames = u16Frames ? u16Frames : BENCH_FRAMES;
+
+    // scratch buffers: effect state, composed output, previous effect state
+    static CRGB tLeds[3 * BENCH_MAX_LEN];
+    static uint16_t tu16Active[SUBSTRIP_MAX_LAYERS * BENCH_MAX_LEN];
+    static SubStrip::TstParticle tParticles[SUBSTRIP_MAX_LAYERS * SUBSTRIP_MAX_PARTICLES];
+    static Palette xPalette;
+    CRGB *pLeds = tLeds;
+    CRGB *pOut = pLeds + BENCH_MAX_LEN;
+    CRGB *pPrev = pOut + BENCH_MAX_LEN;
+    xPalette.eLoad(tBench_Colors, ARRAY_SIZEOF(tBench_Colors));
+    for (uint8_t u8Anim = 0; u8Anim < SubStrip::NB_ANIMS; u8Anim++) {
+        for (uint8_t l = 0; l < ARRAY_SIZEOF(tu16Bench_Lengths); l++) {
+            for (uint8_t s = 0; s < ARRAY_SIZEOF(tu8Bench_Speeds); s++) {
+                uint16_t u16Len = tu16Bench_Lengths[l];
+                uint32_t u32Now = 0;
+                uint64_t u64Bytes = 0;
+                uint64_t u64Elapsed = 0;
+                memset((void *)pLeds, 0, u16Len * sizeof(CRGB));
+                SubStrip xStrip(u16Len, pLeds);
+                xStrip.eSetActivePool(tu16Active);
+                xStrip.eSetParticlePool(tParticles);
+                xStrip.eSetSeed(BENCH_SEED);
+                xStrip.eSetAnimation((SubStrip::TeAnimation)u8Anim, &xPalette, 1000, tu8Bench_Speeds[s]);
+                xStrip.vManageAnimation(u32Now); // clock sync, not measured
+                xStrip.vClearDirty();
+                for (uint16_t f = 0; f < u16Frames; f++) {
+                    memcpy((void *)pPrev, pLeds, u16Len * sizeof(CRGB));
+                    u32Now += BENCH_FRAME_MS;
+                    uint64_t u64Start = u64Bench_Ns();
+                    xStrip.vManageAnimation(u32Now);
+                    if (xStrip.bIsDirty())
+                    { xStrip.eGetSubStrip(pOut, u16Len); }
+                    u64Elapsed += u64Bench_Ns() - u64Start;
+
+                    if (xStrip.bIsDirty()) {
+                        for (uint16_t i = 0; i < u16Len; i++) {
+                            u64Bytes += (pLeds[i] != pPrev[i]) ? sizeof(CRGB) : 0;
+                        }
+                        u64Bytes += 2 * u16Len * sizeof(CRGB);
+                        xStrip.vClearDirty();
+                    }
+                }
+                printf("{\"anim\":\"%s\",\"len\":%u,\"speed\":%u,\"frames\":%u,\"ns_frame\":%u,\"ns_led\":%.2f,\"bytes_frame\":%u}\n",
+                    SubStrip::pcGetAnimName((SubStrip::TeAnimation)u8Anim), u16Len, tu8Bench_Speeds[s], u16Frames,
+                    (uint32_t)(u64Elapsed / u16Frames), (double)u64Elapsed / ((double)u16Frames * u16Len),
+                    (uint32_t)(u64Bytes / u16Frames));
+            }
+        }
+    }
+    vBench_Rotate(u16Frames, pLeds, pOut, &xPalette);
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file Timeslot_test.cpp
+ * @brief Host check of the working hours.
+ * @author Nello
+ * @date 2026-01-26
+ *
+ * Ranges crossing midnight, back-to-back ranges, no range, malformed entries.
+ * Each set is then run against a simulated wall clock the way the schedule
+ * task uses it: state taken at a minute, sleep u16MinutesToEdge(), again.
+ * Every minute slept through must have the state of the last check.
+ *
+ *   make -C test
+ */
+
+#include "Timeslot.h"
+#include <stdio.h>
+
+#define TEST_HM(h, m)       ((uint16_t)((h) * 60 + (m)))
+
+static uint32_t u32Test_Failures = 0;
+
+static void vTest_Check(bool bOk, const char *pcWhat, uint32_t u32Arg) {
+    if (!bOk) {
+        if (u32Test_Failures < 10)
+        { printf("FAIL %s (%u)\n", pcWhat, u32Arg); }
+        u32Test_Failures++;
+    }
+}
+
+/*******************************************************************************
+ * @brief Two days of schedule from every start minute: no edge may be missed
+ ******************************************************************************/
+static void vTest_Clock(const Timeslot &rSlots, const char *pcWhat) {
+    for (uint16_t u16Start = 0; u16Start < TIMESLOT_DAY_MIN; u16Start++) {
+        uint32_t u32Now = u16Start;
+        while (u32Now < (uint32_t)u16Start + 2 * TIMESLOT_DAY_MIN) {
+            uint16_t u16Minute = u32Now % TIMESLOT_DAY_MIN;
+            bool bOn = rSlots.bIsOn(u16Minute);
+            uint16_t u16Sleep = rSlots.u16MinutesToEdge(u16Minute);
+            vTest_Check((u16Sleep >= 1) && (u16Sleep <= TIMESLOT_DAY_MIN), pcWhat, u16Sleep);
+            for (uint16_t m = 1; m < u16Sleep; m++) {
+                uint16_t u16Slept = (u16Minute + m) % TIMESLOT_DAY_MIN;
+                if (rSlots.bIsOn(u16Slept) != bOn) {
+                    vTest_Check(false, pcWhat, u16Slept);
+                    break;
+                }
+            }
+            u32Now += u16Sleep;
+        }
+    }
+}
+
+static void vTest_Midnight(void) {
+    Timeslot xSlots;
+    vTest_Check(xSlots.eAdd("22:00", "06:00") == Timeslot::RET_OK, "midnight add", 0);
+    vTest_Check(!xSlots.bIsOn(TEST_HM(21, 59)), "midnight 21:59", 0);
+    vTest_Check(xSlots.bIsOn(TEST_HM(22, 0)), "midnight 22:00", 0);
+    vTest_Check(xSlots.bIsOn(TEST_HM(23, 59)), "midnight 23:59", 0);
+    vTest_Check(xSlots.bIsOn(TEST_HM(0, 0)), "midnight 00:00", 0);
+    vTest_Check(xSlots.bIsOn(TEST_HM(5, 59)), "midnight 05:59", 0);
+    vTest_Check(!xSlots.bIsOn(TEST_HM(6, 0)), "midnight 06:00", 0);
+    vTest_Check(xSlots.u16MinutesToEdge(TEST_HM(23, 0)) == 7 * 60, "midnight edge 23:00", xSlots.u16MinutesToEdge(TEST_HM(23, 0)));
+    vTest_Check(xSlots.u16MinutesToEdge(TEST_HM(6, 0)) == 16 * 60, "midnight edge 06:00", xSlots.u16MinutesToEdge(TEST_HM(6, 0)));
+    vTest_Clock(xSlots, "midnight clock");
+
+    // ends at midnight exactly
+    xSlots.vClear();
+    xSlots.eAdd("18:00", "00:00");
+    vTest_Check(xSlots.bIsOn(TEST_HM(23, 59)), "to midnight 23:59", 0);
+    vTest_Check(!xSlots.bIsOn(TEST_HM(0, 0)), "to midnight 00:00", 0);
+    vTest_Clock(xSlots, "to midnight clock");
+
+    // ON equal to OFF: the whole day
+    xSlots.vClear();
+    xSlots.eAdd("08:00", "08:00");
+    for (uint16_t m = 0; m < TIMESLOT_DAY_MIN; m++) {
+        vTest_Check(xSlots.bIsOn(m), "whole day", m);
+    }
+    vTest_Clock(xSlots, "whole day clock");
+}
+
+static void vTest_BackToBack(void) {
+    Timeslot xSlots;
+    xSlots.eAdd("17:00", "18:00");
+    xSlots.eAdd("18:00", "19:00");
+    vTest_Check(!xSlots.bIsOn(TEST_HM(16, 59)), "back to back 16:59", 0);
+    vTest_Check(xSlots.bIsOn(TEST_HM(17, 59)), "back to back 17:59", 0);
+    vTest_Check(xSlots.bIsOn(TEST_HM(18, 0)), "back to back 18:00", 0);
+    vTest_Check(!xSlots.bIsOn(TEST_HM(19, 0)), "back to back 19:00", 0);
+    // the shared edge wakes the caller, the state does not change there
+    vTest_Check(xSlots.u16MinutesToEdge(TEST_HM(17, 30)) == 30, "back to back edge", xSlots.u16MinutesToEdge(TEST_HM(17, 30)));
+    vTest_Clock(xSlots, "back to back clock");
+
+    // across midnight, then overlapping
+    xSlots.vClear();
+    xSlots.eAdd("20:00", "00:00");
+    xSlots.eAdd("00:00", "02:00");
+    xSlots.eAdd("01:00", "03:00");
+    vTest_Check(xSlots.bIsOn(TEST_HM(23, 59)), "chain 23:59", 0);
+    vTest_Check(xSlots.bIsOn(TEST_HM(0, 0)), "chain 00:00", 0);
+    vTest_Check(xSlots.bIsOn(TEST_HM(2, 30)), "chain 02:30", 0);
+    vTest_Check(!xSlots.bIsOn(TEST_HM(3, 0)), "chain 03:00", 0);
+    vTest_Clock(xSlots, "chain clock");
+}
+
+static void vTest_Empty(void) {
+    Timeslot xSlots;
+    vTest_Check(xSlots.u8GetNbSlots() == 0, "empty slots", xSlots.u8GetNbSlots());
+    for (uint16_t m = 0; m < TIMESLOT_DAY_MIN; m++) {
+        vTest_Check(xSlots.bIsOn(m), "empty on", m);
+        vTest_Check(xSlots.u16MinutesToEdge(m) == TIMESLOT_DAY_MIN, "empty edge", m);
+    }
+    vTest_Clock(xSlots, "empty clock");
+
+    xSlots.eAdd("09:00", "10:00");
+    xSlots.vClear();
+    vTest_Check(xSlots.bIsOn(TEST_HM(12, 0)), "cleared on", 0);
+}
+
+static void vTest_Malformed(void) {
+    static const char *tpcBad[] = {
+        "", "12", "12:", ":30", "24:00", "12:60", "-1:00", "ab:cd", "12:30x", "12-30", "12:3a",
+    };
+    Timeslot xSlots;
+    for (uint8_t i = 0; i < sizeof(tpcBad) / sizeof(tpcBad[0]); i++) {
+        vTest_Check(xSlots.eAdd(tpcBad[i], "10:00") == Timeslot::RET_BAD_PARAMETER, tpcBad[i], i);
+        vTest_Check(xSlots.eAdd("10:00", tpcBad[i]) == Timeslot::RET_BAD_PARAMETER, tpcBad[i], i);
+    }
+    vTest_Check(xSlots.eAdd(nullptr, "10:00") == Timeslot::RET_BAD_PARAMETER, "null on", 0);
+    vTest_Check(xSlots.eAdd("10:00", nullptr) == Timeslot::RET_BAD_PARAMETER, "null off", 0);
+    vTest_Check(xSlots.u8GetNbSlots() == 0, "nothing added", xSlots.u8GetNbSlots());
+    vTest_Check(xSlots.bIsOn(TEST_HM(3, 0)), "still always on", 0);
+
+    // seconds are accepted and ignored
+    vTest_Check(xSlots.eAdd("07:15:30", "07:45:00") == Timeslot::RET_OK, "seconds", 0);
+    vTest_Check(xSlots.bIsOn(TEST_HM(7, 15)) && !xSlots.bIsOn(TEST_HM(7, 45)), "seconds ignored", 0);
+
+    // the table is full: refused, the others kept
+    for (uint8_t i = xSlots.u8GetNbSlots(); i < TIMESLOT_MAX; i++) {
+        vTest_Check(xSlots.eAdd("01:00", "02:00") == Timeslot::RET_OK, "fill", i);
+    }
+    vTest_Check(xSlots.eAdd("12:00", "13:00") == Timeslot::RET_GENERIC_ERROR, "full", TIMESLOT_MAX);
+    vTest_Check(xSlots.u8GetNbSlots() == TIMESLOT_MAX, "full count", xSlots.u8GetNbSlots());
+    vTest_Check(!xSlots.bIsOn(TEST_HM(12, 30)), "full not added", 0);
+    vTest_Clock(xSlots, "full clock");
+}
+
+int main(void) {
+    vTest_Midnight();
+    vTest_BackToBack();
+    vTest_Empty();
+    vTest_Malformed();
+    printf("timeslot: %s, %u failure(s)\n", u32Test_Failures ? "FAIL" : "ok", u32Test_Failures);
+    return u32Test_Failures ? 1 : 0;
+}
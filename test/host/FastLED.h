@@ -0,0 +1,109 @@
+/**
+ * @file FastLED.h
+ * @brief Host stand-in for the parts of FastLED the kernels and SubStrip use.
+ * @author Nello
+ * @date 2026-01-20
+ *
+ * Scalar paths transcribed from FastLED 3.x lib8tion (FASTLED_SCALE8_FIXED 1,
+ * FASTLED_BLEND_FIXED 1): the reference the kernels are checked against.
+ */
+
+#ifndef _HOST_FASTLED_H
+#define _HOST_FASTLED_H
+
+#include <stdint.h>
+#include <string.h>
+
+typedef uint8_t fract8;
+
+static inline uint8_t scale8(uint8_t i, fract8 scale) {
+    return (((uint16_t)i) * (1 + (uint16_t)(scale))) >> 8;
+}
+
+static inline uint8_t qadd8(uint8_t i, uint8_t j) {
+    unsigned int t = i + j;
+    return (t > 255) ? 255 : t;
+}
+
+static const uint8_t b_m16_interleave[] = {0, 49, 49, 41, 90, 27, 117, 10};
+
+static inline uint8_t sin8(uint8_t theta) {
+    uint8_t offset = theta;
+    if (theta & 0x40) { offset = (uint8_t)255 - offset; }
+    offset &= 0x3F;
+    uint8_t secoffset = offset & 0x0F;
+    if (theta & 0x40) { ++secoffset; }
+    uint8_t section = offset >> 4;
+    const uint8_t *p = b_m16_interleave + section * 2;
+    uint8_t b = p[0];
+    uint8_t m16 = p[1];
+    uint8_t mx = (m16 * secoffset) >> 4;
+    int8_t y = mx + b;
+    if (theta & 0x80) { y = -y; }
+    y += 128;
+    return y;
+}
+
+static inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB) {
+    uint16_t partial;
+    partial = (a << 8) | b;
+    partial += (b * amountOfB);
+    partial -= (a * amountOfB);
+    return partial >> 8;
+}
+
+struct CRGB {
+    union {
+        struct { uint8_t r; uint8_t g; uint8_t b; };
+        uint8_t raw[3];
+    };
+    typedef enum {
+        Black = 0x000000,
+        Blue = 0x0000FF,
+        Green = 0x008000,
+        Red = 0xFF0000,
+        White = 0xFFFFFF,
+    } HTMLColorCode;
+
+    CRGB() {}
+    CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+    CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+    CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) {}
+    CRGB &nscale8(uint8_t scaledown) {
+        uint16_t scale_fixed = scaledown + 1;
+        r = (((uint16_t)r) * scale_fixed) >> 8;
+        g = (((uint16_t)g) * scale_fixed) >> 8;
+        b = (((uint16_t)b) * scale_fixed) >> 8;
+        return *this;
+    }
+    CRGB &fadeToBlackBy(uint8_t fadefactor) { return nscale8(255 - fadefactor); }
+    explicit operator bool() const { return r || g || b; }
+    bool operator==(const CRGB &rhs) const { return (r == rhs.r) && (g == rhs.g) && (b == rhs.b); }
+    bool operator!=(const CRGB &rhs) const { return !(*this == rhs); }
+};
+
+static inline void fill_solid(CRGB *leds, int numToFill, const CRGB &color) {
+    for (int i = 0; i < numToFill; i++) { leds[i] = color; }
+}
+
+static inline CRGB blend(const CRGB &p1, const CRGB &p2, fract8 amountOfP2) {
+    return CRGB(blend8(p1.r, p2.r, amountOfP2), blend8(p1.g, p2.g, amountOfP2), blend8(p1.b, p2.b, amountOfP2));
+}
+
+// FastLED fill_gradient_RGB(), two colors: 8.8 accumulators, 8.7 steps
+static inline void fill_gradient_RGB(CRGB *leds, uint16_t numLeds, const CRGB &c1, const CRGB &c2) {
+    uint16_t last = numLeds ? (numLeds - 1) : 0;
+    int16_t divisor = last ? last : 1;
+    int16_t rdelta87 = (int16_t)(((c2.r - c1.r) << 7) / divisor) * 2;
+    int16_t gdelta87 = (int16_t)(((c2.g - c1.g) << 7) / divisor) * 2;
+    int16_t bdelta87 = (int16_t)(((c2.b - c1.b) << 7) / divisor) * 2;
+    uint16_t r88 = c1.r << 8, g88 = c1.g << 8, b88 = c1.b << 8;
+    for (uint16_t i = 0; i <= last; i++) {
+        leds[i] = CRGB(r88 >> 8, g88 >> 8, b88 >> 8);
+        r88 += rdelta87;
+        g88 += gdelta87;
+        b88 += bdelta87;
+    }
+}
+
+#endif // _HOST_FASTLED_H